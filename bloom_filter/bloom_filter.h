@@ -2,7 +2,17 @@
 *
 *  Name: bloom_filter.h
 *
-*  Purpose: Contains implementation of a width bloom filter.
+*  Purpose: Contains implementation of blocked bloom filters.
+*
+*           Each object hashes to one 64 byte block (a cache line) and sets K
+*           bits in that block, so encoding or checking an object touches one
+*           line of memory no matter how big the filter is. The K bits are
+*           picked by double hashing, 'a + i * b' for i = 0..K-1, from a
+*           single hash of the object.
+*
+*           The counting variant keeps a 4 bit counter instead of each bit so
+*           objects can be removed, e.g. to keep a filter of the last N objects
+*           seen.
 *
 *  Author: Will Merges
 *
@@ -13,34 +23,265 @@
 #define BLOOM_FILTER_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include "hash/hash.h"
 
-/// @brief bloom filter
-///        width of 'size_t' type
+namespace bloom_internal {
+
+/// @brief number of 64 bit words in a block, one 64 byte cache line
+static const size_t BLOCK_WORDS = 8;
+
+/// @brief helper function to pick the block and probe sequence for a hash
+/// @param hash     the object's hash
+/// @param mask     the number of blocks minus one
+/// @param a        set to the first probe
+/// @param b        set to the step between probes, always odd so the first
+///                 probes within a block never repeat
+/// @return the block index
+static inline size_t probes(size_t hash, size_t mask, size_t* a, size_t* b) {
+    // the block comes from the hash, the probes from a remix of it so they
+    // don't depend on which block was picked
+    size_t mix = hash_mix(hash);
+
+    *a = mix;
+    *b = (mix >> (sizeof(size_t) * 4)) | 1;
+
+    return hash & mask;
+}
+
+// smallest power of two number of blocks that holds 'n' entries of 'per_block'
+static constexpr size_t num_blocks(size_t n, size_t per_block) {
+    return (n <= per_block) ? 1 : 2 * num_blocks((n + 1) / 2, per_block);
+}
+
+}
+
+/// @brief blocked bloom filter
 /// @tparam T       the object stored in the filter
-/// @tparam HASH    the hash to hash the object with, defaults to an XOR hash
-template <typename T, typename HASH = XORHash<T>>
+/// @tparam HASH    the hash to hash the object with, should be well mixed
+template <typename T, typename HASH = DefaultHash<T>>
 class BloomFilter {
 public:
-    /// @brief constructor
-    BloomFilter() : m_data(0), m_hash() {};
+    /// @brief encode an object into the filter
+    void encode(const T& obj) {
+        size_t a;
+        size_t b;
+        uint64_t* block = m_blocks + bloom_internal::BLOCK_WORDS *
+                          bloom_internal::probes(m_hash(obj), m_mask, &a, &b);
+
+        for(size_t i = 0; i < m_k; i++) {
+            size_t bit = a & (BLOCK_BITS - 1);
+            block[bit >> 6] |= (uint64_t)1 << (bit & 63);
+            a += b;
+        }
+    }
+
+    /// @brief check if an object may be present in the filter
+    /// @return 'true' if the object MAY be encoded in the filter
+    ///         'false' if the object is certainly not in the filter
+    bool present(const T& obj) {
+        size_t a;
+        size_t b;
+        uint64_t* block = m_blocks + bloom_internal::BLOCK_WORDS *
+                          bloom_internal::probes(m_hash(obj), m_mask, &a, &b);
+
+        for(size_t i = 0; i < m_k; i++) {
+            size_t bit = a & (BLOCK_BITS - 1);
+            if(!(block[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+                return false;
+            }
+            a += b;
+        }
 
+        return true;
+    }
+
+    /// @brief remove every object from the filter
+    void clear() {
+        for(size_t i = 0; i < (m_mask + 1) * bloom_internal::BLOCK_WORDS; i++) {
+            m_blocks[i] = 0;
+        }
+    }
+
+protected:
+    /// @brief protected constructor, use alloc::BloomFilter to declare
+    /// @param blocks       storage for 'num_blocks' blocks
+    /// @param num_blocks   the number of blocks, a power of two
+    /// @param k            the number of bits set per object
+    BloomFilter(uint64_t* blocks, size_t num_blocks, size_t k) : m_blocks(blocks),
+                                                                 m_mask(num_blocks - 1),
+                                                                 m_k(k),
+                                                                 m_hash() {
+        clear();
+    }
+
+private:
+    static const size_t BLOCK_BITS = bloom_internal::BLOCK_WORDS * 64;
+
+    uint64_t* m_blocks;
+    size_t m_mask;
+    size_t m_k;
+
+    HASH m_hash;
+};
+
+/// @brief blocked counting bloom filter, objects can be removed
+///        counters saturate at 15 and are never decremented after, so a
+///        heavily loaded filter only gets more false positives, never false
+///        negatives
+/// @tparam T       the object stored in the filter
+/// @tparam HASH    the hash to hash the object with, should be well mixed
+template <typename T, typename HASH = DefaultHash<T>>
+class CountingBloomFilter {
+public:
     /// @brief encode an object into the filter
-    void encode(T& obj) {
-        m_data |= m_hash(obj);
+    void encode(const T& obj) {
+        size_t a;
+        size_t b;
+        uint64_t* block = m_blocks + bloom_internal::BLOCK_WORDS *
+                          bloom_internal::probes(m_hash(obj), m_mask, &a, &b);
+
+        for(size_t i = 0; i < m_k; i++) {
+            size_t c = a & (BLOCK_COUNTERS - 1);
+            uint64_t& word = block[c >> 4];
+            size_t shift = (c & 15) * 4;
+
+            if(((word >> shift) & 0xF) != 0xF) {
+                word += (uint64_t)1 << shift;
+            }
+
+            a += b;
+        }
+    }
+
+    /// @brief remove an object from the filter
+    /// @return 'true' on success, 'false' if the object wasn't in the filter
+    /// NOTE: only remove objects that were encoded, removing a false positive
+    ///       can remove other objects
+    bool remove(const T& obj) {
+        if(!present(obj)) {
+            return false;
+        }
+
+        size_t a;
+        size_t b;
+        uint64_t* block = m_blocks + bloom_internal::BLOCK_WORDS *
+                          bloom_internal::probes(m_hash(obj), m_mask, &a, &b);
+
+        for(size_t i = 0; i < m_k; i++) {
+            size_t c = a & (BLOCK_COUNTERS - 1);
+            uint64_t& word = block[c >> 4];
+            size_t shift = (c & 15) * 4;
+
+            if(((word >> shift) & 0xF) != 0xF) {
+                word -= (uint64_t)1 << shift;
+            }
+
+            a += b;
+        }
+
+        return true;
     }
 
     /// @brief check if an object may be present in the filter
     /// @return 'true' if the object MAY be encoded in the filter
     ///         'false' if the object is certainly not in the filter
-    bool present(T& obj) {
-        return (~m_data & m_hash(obj)) == 0;
+    bool present(const T& obj) {
+        size_t a;
+        size_t b;
+        uint64_t* block = m_blocks + bloom_internal::BLOCK_WORDS *
+                          bloom_internal::probes(m_hash(obj), m_mask, &a, &b);
+
+        for(size_t i = 0; i < m_k; i++) {
+            size_t c = a & (BLOCK_COUNTERS - 1);
+            if(!((block[c >> 4] >> ((c & 15) * 4)) & 0xF)) {
+                return false;
+            }
+            a += b;
+        }
+
+        return true;
+    }
+
+    /// @brief remove every object from the filter
+    void clear() {
+        for(size_t i = 0; i < (m_mask + 1) * bloom_internal::BLOCK_WORDS; i++) {
+            m_blocks[i] = 0;
+        }
+    }
+
+protected:
+    /// @brief protected constructor, use alloc::CountingBloomFilter to declare
+    /// @param blocks       storage for 'num_blocks' blocks
+    /// @param num_blocks   the number of blocks, a power of two
+    /// @param k            the number of counters incremented per object
+    CountingBloomFilter(uint64_t* blocks, size_t num_blocks, size_t k) : m_blocks(blocks),
+                                                                         m_mask(num_blocks - 1),
+                                                                         m_k(k),
+                                                                         m_hash() {
+        clear();
     }
 
 private:
-    size_t m_data;
+    static const size_t BLOCK_COUNTERS = bloom_internal::BLOCK_WORDS * 16;
+
+    uint64_t* m_blocks;
+    size_t m_mask;
+    size_t m_k;
+
     HASH m_hash;
 };
 
+namespace alloc {
+
+/// @brief preallocated blocked bloom filter
+/// @tparam T       the object stored in the filter
+/// @tparam BITS    the number of bits in the filter, rounded up to a power of
+///                 two number of 512 bit blocks
+///                 about 10 bits per object stored gives a 1% false positive
+///                 rate, 16 bits about 0.1%
+/// @tparam K       the number of bits set per object, 7 is a good default
+/// @tparam HASH    the hash to hash the object with, defaults to the one
+///                 'HashTraits' picks for the type
+template <typename T, const size_t BITS, const size_t K = 7,
+          typename HASH = DefaultHash<T>>
+class BloomFilter : public ::BloomFilter<T, HASH> {
+public:
+    static_assert(K > 0 && K <= 64, "BloomFilter K must be between 1 and 64");
+
+    /// @brief constructor
+    BloomFilter() : ::BloomFilter<T, HASH>(m_internalBlocks, NUM_BLOCKS, K) {};
+
+private:
+    static constexpr size_t NUM_BLOCKS = bloom_internal::num_blocks(BITS, 512);
+
+    alignas(64) uint64_t m_internalBlocks[NUM_BLOCKS * bloom_internal::BLOCK_WORDS];
+};
+
+/// @brief preallocated blocked counting bloom filter
+/// @tparam T           the object stored in the filter
+/// @tparam COUNTERS    the number of 4 bit counters in the filter, rounded up to
+///                     a power of two number of 128 counter blocks
+///                     sized like the bits of a BloomFilter
+/// @tparam K           the number of counters incremented per object
+/// @tparam HASH        the hash to hash the object with, defaults to the one
+///                     'HashTraits' picks for the type
+template <typename T, const size_t COUNTERS, const size_t K = 7,
+          typename HASH = DefaultHash<T>>
+class CountingBloomFilter : public ::CountingBloomFilter<T, HASH> {
+public:
+    static_assert(K > 0 && K <= 64, "CountingBloomFilter K must be between 1 and 64");
+
+    /// @brief constructor
+    CountingBloomFilter() : ::CountingBloomFilter<T, HASH>(m_internalBlocks, NUM_BLOCKS, K) {};
+
+private:
+    static constexpr size_t NUM_BLOCKS = bloom_internal::num_blocks(COUNTERS, 128);
+
+    alignas(64) uint64_t m_internalBlocks[NUM_BLOCKS * bloom_internal::BLOCK_WORDS];
+};
+
+}
+
 #endif
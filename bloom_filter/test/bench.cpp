@@ -0,0 +1,137 @@
+// benchmarks the blocked bloom filter against a standard one where every bit
+// can be anywhere in the filter, false positive rate and time per operation,
+// for thousands of frame IDs, and the counting filter over a sliding window
+//
+// build: g++ -O2 -I../.. bench.cpp -o bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bloom_filter/bloom_filter.h"
+
+static const size_t IDS = 4096;
+static const size_t CHECKS = 1000000;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// standard bloom filter, K probes over the whole filter
+template <size_t BITS, size_t K>
+class FlatBloomFilter {
+public:
+    FlatBloomFilter() {
+        for(size_t i = 0; i < BITS / 64; i++) {
+            m_words[i] = 0;
+        }
+    }
+
+    void encode(const uint32_t& obj) {
+        uint64_t a = hash_mix64(obj);
+        uint64_t b = (a >> 32) | 1;
+
+        for(size_t i = 0; i < K; i++) {
+            size_t bit = a % BITS;
+            m_words[bit >> 6] |= (uint64_t)1 << (bit & 63);
+            a += b;
+        }
+    }
+
+    bool present(const uint32_t& obj) {
+        uint64_t a = hash_mix64(obj);
+        uint64_t b = (a >> 32) | 1;
+
+        for(size_t i = 0; i < K; i++) {
+            size_t bit = a % BITS;
+            if(!(m_words[bit >> 6] & ((uint64_t)1 << (bit & 63)))) {
+                return false;
+            }
+            a += b;
+        }
+
+        return true;
+    }
+
+private:
+    uint64_t m_words[BITS / 64];
+};
+
+static volatile size_t sink;
+
+// encode IDS IDs, then check CHECKS that were never encoded
+template <typename F>
+void run(const char* name, F& filter) {
+    uint32_t base = 0x1000;
+
+    uint64_t start = now_ns();
+    for(uint32_t i = 0; i < IDS; i++) {
+        filter.encode(base + i * 3);
+    }
+    double encode_ns = (double)(now_ns() - start) / IDS;
+
+    size_t fp = 0;
+    start = now_ns();
+    for(uint32_t i = 0; i < CHECKS; i++) {
+        if(filter.present(base + IDS * 3 + i)) {
+            fp++;
+        }
+    }
+    double check_ns = (double)(now_ns() - start) / CHECKS;
+    sink = fp;
+
+    printf("%-26s %10.3f%% %12.2f %11.2f\n", name, 100.0 * fp / CHECKS, encode_ns, check_ns);
+}
+
+// sliding window of the last IDS IDs, remove the oldest and check and encode
+// the newest
+template <typename F>
+void run_window(const char* name, F& filter) {
+    static uint32_t recent[IDS];
+    size_t fp = 0;
+
+    uint64_t start = now_ns();
+    for(uint32_t n = 0; n < CHECKS; n++) {
+        uint32_t id = 0x1000 + n * 3;
+
+        if(n >= IDS) {
+            filter.remove(recent[n % IDS]);
+        }
+
+        if(filter.present(id)) {
+            fp++;
+        }
+
+        filter.encode(id);
+        recent[n % IDS] = id;
+    }
+    double ns = (double)(now_ns() - start) / CHECKS;
+
+    printf("%-26s %10.3f%% %24.2f\n", name, 100.0 * fp / CHECKS, ns);
+}
+
+int main() {
+    printf("%-26s %11s %12s %11s\n", "4096 IDs", "false pos", "encode (ns)", "check (ns)");
+
+    static FlatBloomFilter<IDS * 10, 7> flat10;
+    static FlatBloomFilter<IDS * 16, 7> flat16;
+    static alloc::BloomFilter<uint32_t, IDS * 10, 7> blocked10;
+    static alloc::BloomFilter<uint32_t, IDS * 16, 7> blocked16;
+    static alloc::BloomFilter<uint32_t, IDS * 16, 11> blocked16_11;
+
+    run("flat 10 bits/ID", flat10);
+    run("flat 16 bits/ID", flat16);
+    run("blocked 10 bits/ID", blocked10);
+    run("blocked 16 bits/ID", blocked16);
+    run("blocked 16 bits/ID, K=11", blocked16_11);
+
+    printf("\n%-26s %11s %24s\n", "window of 4096 IDs", "false pos", "remove+check+encode (ns)");
+
+    static alloc::CountingBloomFilter<uint32_t, IDS * 16, 7> counting16;
+    static alloc::CountingBloomFilter<uint32_t, IDS * 32, 7> counting32;
+    run_window("counting 16 counters/ID", counting16);
+    run_window("counting 32 counters/ID", counting32);
+}
@@ -1,3 +1,5 @@
+// build: g++ -I../.. test.cpp -o test
+
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -10,7 +12,7 @@ typedef struct {
 } some_type_t;
 
 bool basic() {
-    BloomFilter<some_type_t> filter; // use the default XOR hash
+    alloc::BloomFilter<some_type_t, 512> filter; // use the default hash
 
     some_type_t fst = {1, 2, -3};
     filter.encode(fst);
@@ -39,6 +41,133 @@ bool basic() {
         return false;
     }
 
+    filter.clear();
+    if(filter.present(fst) || filter.present(snd)) {
+        printf("values present after clear\n");
+        return false;
+    }
+
+    return true;
+}
+
+// frame IDs, 4096 in a 64 Kbit filter
+bool false_positives() {
+    static alloc::BloomFilter<uint32_t, 4096 * 16> filter;
+
+    srand(1);
+    uint32_t base = rand();
+
+    for(uint32_t i = 0; i < 4096; i++) {
+        filter.encode(base + i);
+    }
+
+    for(uint32_t i = 0; i < 4096; i++) {
+        if(!filter.present(base + i)) {
+            printf("false negative\n");
+            return false;
+        }
+    }
+
+    size_t fp = 0;
+    for(uint32_t i = 4096; i < 4096 + 100000; i++) {
+        if(filter.present(base + i)) {
+            fp++;
+        }
+    }
+
+    if(fp >= 1000) {
+        printf("false positive rate %.3f%%\n", fp / 1000.0);
+        return false;
+    }
+
+    return true;
+}
+
+bool counting() {
+    alloc::CountingBloomFilter<uint32_t, 1024> filter;
+
+    for(uint32_t i = 0; i < 64; i++) {
+        filter.encode(i);
+    }
+
+    // encoded twice, needs removing twice
+    filter.encode(7);
+
+    if(filter.remove(1000)) {
+        printf("removed a value that wasn't encoded\n");
+        return false;
+    }
+
+    for(uint32_t i = 0; i < 64; i += 2) {
+        if(!filter.remove(i)) {
+            printf("failed to remove %u\n", i);
+            return false;
+        }
+    }
+
+    for(uint32_t i = 1; i < 64; i += 2) {
+        if(!filter.present(i)) {
+            printf("%u lost when others were removed\n", i);
+            return false;
+        }
+    }
+
+    if(!filter.remove(7) || !filter.present(7)) {
+        printf("value encoded twice gone after one remove\n");
+        return false;
+    }
+
+    for(uint32_t i = 1; i < 64; i += 2) {
+        filter.remove(i);
+    }
+
+    // every counter is back to zero
+    for(uint32_t i = 0; i < 64; i++) {
+        if(filter.present(i)) {
+            printf("%u present after every value removed\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the last 4096 of a stream of IDs, the way duplicate frames are found
+bool window() {
+    static const size_t WINDOW = 4096;
+    static alloc::CountingBloomFilter<uint32_t, WINDOW * 16> filter;
+    static uint32_t recent[WINDOW];
+
+    srand(2);
+    size_t fp = 0;
+    size_t checks = 0;
+
+    for(size_t n = 0; n < 200000; n++) {
+        uint32_t id = rand();
+
+        if(n >= WINDOW) {
+            // forget the oldest
+            if(!filter.remove(recent[n % WINDOW])) {
+                printf("lost an ID still in the window\n");
+                return false;
+            }
+
+            // an ID not seen before
+            checks++;
+            if(filter.present(id)) {
+                fp++;
+            }
+        }
+
+        filter.encode(id);
+        recent[n % WINDOW] = id;
+    }
+
+    if(fp * 100 >= checks) {
+        printf("false positive rate %.3f%%\n", 100.0 * fp / checks);
+        return false;
+    }
+
     return true;
 }
 
@@ -48,4 +177,22 @@ int main() {
     } else {
         printf("basic test failed\n");
     }
+
+    if(false_positives()) {
+        printf("false positive test passed\n");
+    } else {
+        printf("false positive test failed\n");
+    }
+
+    if(counting()) {
+        printf("counting test passed\n");
+    } else {
+        printf("counting test failed\n");
+    }
+
+    if(window()) {
+        printf("window test passed\n");
+    } else {
+        printf("window test failed\n");
+    }
 }
@@ -16,3 +16,9 @@
 
 // define to track statistics for network layers
 #define NET_STATISTICS
+
+
+// scheduler configuration information
+
+// define to profile task run time and allow tracing dispatches
+// #define SCHED_PROFILE
@@ -20,12 +20,23 @@
 
 #include "queue/allocated_queue.h"
 #include "return.h"
+#include "sched/sched.h"
+
+/// @brief what causes a device's 'poll' function to be called
+typedef enum {
+    POLL_CONTINUOUS = 0,    // polled every time its task is dispatched
+    POLL_EVENT,             // polled after 'poll_request' is called, or when
+                            // 'poll_fd' is readable on Linux
+    POLL_PERIODIC,          // polled every 'poll_period' ticks
+    POLL_NONE               // never polled, no task is started for the device
+} poll_source_t;
 
 /// @brief generic device
 class Device {
 public:
     /// @brief constructor
-    Device(const char* name) :  m_uid(uid_counter), m_name(name) {
+    Device(const char* name) :  m_uid(uid_counter), m_name(name),
+                                m_poll_tid(-1) {
         uid_counter++;
     };
 
@@ -62,6 +73,45 @@ public:
         return RET_ERROR;
     }
 
+    /// @brief get what should cause this device to be polled
+    ///        devices that only do work in response to an interrupt or a file
+    ///        descriptor should use POLL_EVENT, so they aren't dispatched
+    ///        while there's nothing to do
+    /// @return the poll source, POLL_CONTINUOUS unless overridden
+    virtual poll_source_t poll_source() {
+        return POLL_CONTINUOUS;
+    }
+
+    /// @brief get the time between polls for a POLL_PERIODIC device
+    /// @return the period in scheduler ticks
+    virtual uint32_t poll_period() {
+        return 0;
+    }
+
+    /// @brief get a file descriptor that should wake a POLL_EVENT device
+    ///        when it's readable, only used on Linux
+    /// @return the file descriptor, or -1 if there isn't one
+    virtual int poll_fd() {
+        return -1;
+    }
+
+    /// @brief request a POLL_EVENT device be polled
+    ///        safe to call from an interrupt, the device is polled on the next
+    ///        dispatch
+    void poll_request() {
+        tid_t tid = m_poll_tid;
+
+        if(-1 != tid) {
+            sched_wake_isr(tid);
+        }
+    }
+
+    /// @brief set the task that polls this device
+    ///        called by 'init' when it starts the task
+    void set_poll_task(tid_t tid) {
+        m_poll_tid = tid;
+    }
+
     /// @brief get unique ID of this device
     /// @return the unique id
     uint16_t uid() const {
@@ -83,6 +133,9 @@ protected:
     uint16_t m_uid;
     const char* m_name;
 
+    // task that polls this device, -1 if there isn't one
+    volatile tid_t m_poll_tid;
+
 private:
     static uint16_t uid_counter; // should initialize to 0
 };
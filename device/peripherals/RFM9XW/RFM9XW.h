@@ -143,6 +143,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() {
+        return POLL_NONE;
+    }
+
 private:
     SPIDevice &m_spi;
     GPIODevice &m_cs;
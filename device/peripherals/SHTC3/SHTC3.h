@@ -146,6 +146,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() override {
+        return POLL_NONE;
+    }
+
     RetType obtain() override {
         return RET_SUCCESS;
     }
@@ -11,6 +11,8 @@
 #include "device/GPIODevice.h"
 #include "sched/sched.h"
 #include "sched/macros.h"
+#include "sync/BlockingSemaphore.h"
+#include "sync/WaitQueue.h"
 #include "device/BlockDevice.h"
 
 #include "device/platforms/stm32/swdebug.h"
@@ -106,23 +108,32 @@ public:
         uint8_t mask = (uint8_t) S_BUSY;
 
     	RESUME();
-    	if (TID_UNBLOCKED != m_blocked) { // if a task is blocked on this device
+    	if (0 != m_idle.size()) { // if any tasks are blocked on this device
 
 			CHECK_CALL(read_status(READ_ONE, &status)); // is the chip still busy?
 
-			if (0 == (status & mask)) { // if not, unblock the blocked task
-				m_blocked = TID_UNBLOCKED;
-				WAKE(m_blocked);
+			if (0 == (status & mask)) { // if not, unblock the blocked tasks
+				m_idle.wake_all();
 			}
         }
     	RESET();
         return RET_SUCCESS;
     }
 
+    /* @brief check the busy register every tick rather than every dispatch,
+     * a page program or erase takes at least that long
+     */
+    poll_source_t poll_source() override {
+        return POLL_PERIODIC;
+    }
+
+    uint32_t poll_period() override {
+        return 1;
+    }
+
 //private:
 
     const uint8_t DUMMY_BYTE = 0xA5;
-    const tid_t TID_UNBLOCKED = -1;
 
     const uint32_t CS_ACTIVE = 0U;
     const uint32_t CS_INACTIVE = 1U;
@@ -186,7 +197,7 @@ public:
 	};
 
     // device could be busy doing a write op, need to have a block/unblock mechanism
-    tid_t m_blocked = TID_UNBLOCKED; // the task blocked on this device
+    WaitQueue m_idle; // tasks blocked waiting for the device to not be busy
     BlockingSemaphore m_lock;
 
     // necessary peripherals
@@ -200,9 +211,8 @@ public:
     size_t page_count = 0;
 
     /* @brief uses a read operation to check the BUSY register
-     * stores the currently dispatched task in m_blocked and blocks if the mem is busy
-     * @return if there is already a task blocked on this device, RET_ERROR
-     * 			if register read does not succeed, its return value
+     * waits on m_idle if the mem is busy, any number of tasks can wait at once
+     * @return	if register read does not succeed, its return value
      * 			if device is busy flushing, RET_BLOCKED
      * 			otherwise RET_SUCCESS
      */
@@ -211,17 +221,11 @@ public:
         uint8_t mask = (uint8_t) S_BUSY;
 
     	RESUME();
-    	if (TID_UNBLOCKED != m_blocked) {
-    		// the blocked ID has been changed from default, so someone else is using this
-    		RESET();
-    		return RET_ERROR;
-    	}
 
     	CHECK_CALL(read_status(READ_ONE, &status));
 
-    	if (status & mask) { // busy bit set, we block
-    		m_blocked = sched_dispatched;
-    		BLOCK();
+    	if (status & mask) { // busy bit set, we block until poll sees it clear
+    		CALL(m_idle.wait());
     	}
 
     	RESET();
@@ -34,6 +34,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() override {
+        return POLL_NONE;
+    }
+
     RetType set(uint32_t val) override {
         if (ESP_ERR_INVALID_ARG == gpio_set_level(m_gpio_num, val)) {
             return RET_ERROR;
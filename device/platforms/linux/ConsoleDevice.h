@@ -6,7 +6,8 @@
 #include <sys/select.h>
 #include <sys/time.h>
 
-#include "sched/macros/macros.h"
+#include "sched/macros.h"
+#include "sync/WaitQueue.h"
 #include "device/Device.h"
 #include "device/StreamDevice.h"
 #include "ringbuffer/RingBuffer.h"
@@ -16,8 +17,8 @@ class LinuxConsoleDevice : public StreamDevice {
 public:
     LinuxConsoleDevice() : m_rxBuff(),
                            m_lock(false),
-                           m_blockTid(-1),
-                           m_blockLen(0),
+                           m_waiters(),
+                           m_eof(false),
                            StreamDevice("Linux Console Device") {};
 
     RetType init() {
@@ -43,7 +44,7 @@ public:
 
     RetType poll() {
         // check if there's any data on stdin
-        // if there is, read a character and push it to the ringbuffer
+        // if there is, read it straight into the ringbuffer
 
         struct timeval tv = { 0L, 0L };
         fd_set fds;
@@ -51,22 +52,44 @@ public:
         FD_SET(0, &fds);
 
         if(select(1, &fds, NULL, NULL, &tv) > 0) {
-            char c = getchar();
-            if(1 != m_rxBuff.push((uint8_t*)&c, sizeof(char))) {
+            ringbuffer_span_t spans[2];
+
+            if(0 == m_rxBuff.reserve_spans(spans)) {
+                // full, drop the oldest data to make room like a push would
+                m_rxBuff.commit_read(1);
+                m_rxBuff.reserve_spans(spans);
+            }
+
+            ssize_t len = ::read(0, spans[0].buff, spans[0].len);
+            if(len < 0) {
                 return RET_ERROR;
             }
 
-            if(m_blockTid != -1) {
-                if(m_rxBuff.size() >= m_blockLen) {
-                    WAKE(m_blockTid);
-                    m_blockTid = -1; // TODO instead of -1 #define an invalid TID somewhere
-                }
+            if(0 == len) {
+                // end of file, stdin will always look readable now
+                m_eof = true;
+                return RET_SUCCESS;
             }
+
+            m_rxBuff.commit_write(len);
+
+            // wake anyone waiting for data, they each check if there's
+            // enough for them
+            m_waiters.wake_all();
         }
 
         return RET_SUCCESS;
     }
 
+    // only poll when stdin is readable
+    poll_source_t poll_source() {
+        return POLL_EVENT;
+    }
+
+    int poll_fd() {
+        return m_eof ? -1 : 0;
+    }
+
     RetType write(uint8_t* buff, size_t len) {
         if(-1 == ::write(1, buff, len)) {
             return RET_ERROR;
@@ -78,19 +101,20 @@ public:
     RetType read(uint8_t* buff, size_t len) {
         RESUME();
 
-        if(m_rxBuff.size() >= len) {
-            if(len != m_rxBuff.pop(buff, len)) {
-                return RET_ERROR;
-            }
-
-            return RET_SUCCESS;
+        // block until there's enough data
+        RetType ret = CALL(wait(len));
+        if(RET_SUCCESS != ret) {
+            RESET();
+            return ret;
         }
 
-        // otherwise block
-        RetType ret = CALL(wait(len));
+        if(len != m_rxBuff.pop(buff, len)) {
+            RESET();
+            return RET_ERROR;
+        }
 
         RESET();
-        return ret;
+        return RET_SUCCESS;
     }
 
     size_t available() {
@@ -98,14 +122,14 @@ public:
     }
 
     // wait for a specific amount of data
-    // called a second time after caller is woken, must remember location and return success
+    // any number of tasks can wait at once, another waiter may take the data
+    // we were woken for so check again every time we're woken
     RetType wait(size_t len) {
         RESUME();
 
-        m_blockLen = len;
-        m_blockTid = sched_dispatched;
-
-        BLOCK();
+        while(m_rxBuff.size() < len) {
+            CALL(m_waiters.wait());
+        }
 
         RESET();
         return RET_SUCCESS;
@@ -115,8 +139,11 @@ private:
     alloc::RingBuffer<256, true> m_rxBuff;
     bool m_lock;
 
-    tid_t m_blockTid;
-    size_t m_blockLen;
+    // tasks waiting for data
+    WaitQueue m_waiters;
+
+    // set once stdin is closed
+    bool m_eof;
 };
 
 #endif
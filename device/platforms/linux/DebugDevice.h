@@ -36,6 +36,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() {
+        return POLL_NONE;
+    }
+
     RetType write(uint8_t* buff, size_t len) {
         if(-1 == ::write(2, buff, len)) {
             return RET_ERROR;
@@ -22,7 +22,7 @@
 #include "device/BlockDevice.h"
 #include "return.h"
 #include "sched/macros/macros.h"
-#include "queue/allocated_queue.h"
+#include "queue/ring_queue.h"
 
 
 class LinuxBlockDevice : public BlockDevice {
@@ -84,8 +84,10 @@ public:
         tid_t* task = m_queue.peek();
 
         while(task != NULL) {
+            // copy the TID before popping, the slot is free after
+            tid_t tid = *task;
             m_queue.pop();
-            WAKE(*task);
+            WAKE(tid);
 
             task = m_queue.peek();
         }
@@ -170,7 +172,7 @@ private:
     void* m_data;
 
     // queues TID of blocked tasks
-    alloc::Queue<tid_t, MAX_NUM_TASKS> m_queue;
+    alloc::RingQueue<tid_t, MAX_NUM_TASKS> m_queue;
 };
 
 #endif
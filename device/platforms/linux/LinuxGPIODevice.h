@@ -13,7 +13,7 @@
 #include <cstdio>
 
 
-#include "sched/macros/macros.h"
+#include "sched/macros.h"
 #include "device/GPIODevice.h"
 #include "sync/BlockingSemaphore.h"
 
@@ -43,6 +43,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() override {
+        return POLL_NONE;
+    }
+
     RetType release() override {
         return RET_SUCCESS;
     }
@@ -44,6 +44,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() override {
+        return POLL_NONE;
+    }
+
 
     RetType set(uint32_t val) override {
         if (!(val == 0 || val == 1)) {
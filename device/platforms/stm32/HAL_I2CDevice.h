@@ -8,6 +8,7 @@
 #include "device/platforms/stm32/HAL_Handlers.h"
 #include "sched/macros.h"
 #include "sync/BlockingSemaphore.h"
+#include "sync/WaitQueue.h"
 
 /// @brief I2C device controller
 class HALI2CDevice : public I2CDevice, public CallbackDevice {
@@ -16,10 +17,10 @@ public:
     /// @param name     the name of this device
     /// @param h12c     the HAL I2C device wrapped by this device
     HALI2CDevice(const char *name, I2C_HandleTypeDef *hi2c) : I2CDevice(name),
-                                                              m_blocked(-1),
+                                                              m_done(),
+                                                              m_owner(-1),
                                                               m_i2c(hi2c),
-                                                              m_lock(1),
-                                                              m_isr_flag(0) {};
+                                                              m_lock(1) {};
 
     /// @brief initialize
     RetType init() {
@@ -51,34 +52,18 @@ public:
     }
 
     /// @brief poll this device
+    ///        the interrupt at the end of a transfer wakes the waiting task
+    ///        through the scheduler, so there's nothing to poll
+    /// @return always successful
     RetType poll() {
-        // disable interrupts to protect access to 'm_isr_flag'
-        __disable_irq();
-
-        if (m_isr_flag) {
-            // an interrupt occurred
-
-            // reset the flag
-            m_isr_flag = 0;
-
-            // re-enable interrupts
-            __enable_irq();
-
-            // if a task was blocked waiting for completion of this ISR, wake it up
-            if(m_blocked != -1) {
-                WAKE(m_blocked);
-
-                // set this task as woken
-                m_blocked = -1;
-            }
-        } else {
-            // re-enable interrupts immediately
-            __enable_irq();
-        }
-
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() {
+        return POLL_NONE;
+    }
+
     /// @brief transmit to an I2C device
     /// @param addr     the I2C address to write to
     /// @param buff     the buffer to write
@@ -96,34 +81,21 @@ public:
             return ret;
         }
 
-        // mark this task as blocked
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_I2C_Master_Transmit_IT(m_i2c, addr.dev_addr, buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if(0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if(m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // release the lock so the next waiter can use the device
         ret = CALL(m_lock.release());
@@ -158,35 +130,22 @@ public:
             return ret;
         }
 
-        // mark this task as blocked
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_I2C_Mem_Write_IT(m_i2c, addr.dev_addr, addr.mem_addr,
                                                addr.mem_addr_size, buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if(0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if(m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // release the lock so the next waiter can use the device
         ret = CALL(m_lock.release());
@@ -221,13 +180,13 @@ public:
             return ret;
         }
 
-        // mark this task as blocked
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_I2C_Master_Receive_IT(m_i2c, addr.dev_addr,
                                                             buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
 
             RESET();
@@ -235,22 +194,9 @@ public:
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if(0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if(m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // release the lock so the next waiter can use the device
         ret = CALL(m_lock.release());
@@ -286,13 +232,13 @@ public:
             return ret;
         }
 
-        // mark this task as blocked
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_I2C_Mem_Read_IT(m_i2c, addr.dev_addr, addr.mem_addr,
                                           addr.mem_addr_size, buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
 
             RESET();
@@ -300,22 +246,9 @@ public:
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if(0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if(m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // release the lock so the next waiter can use the device
         ret = CALL(m_lock.release());
@@ -351,63 +284,37 @@ public:
             return ret;
         }
 
-        // mark this task as blocked BEFORE we call the interrupt function
-        // we want to make sure there is no race condition b/w processing the ISR
-        // and blocking the task
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_I2C_Master_Transmit_IT(m_i2c, addr.dev_addr, buff, inLen)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
-        bool timed_out;
-        if (0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if (m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // block and wait for the transfer to complete
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         if (secondAddr != 0x00) {
             addr.dev_addr = secondAddr;
         }
 
+        m_owner = sched_dispatched;
         if (HAL_OK != HAL_I2C_Master_Receive_IT(m_i2c, addr.dev_addr, buff, outLen)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        if (0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if (m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // release the lock so the next waiter can use the device
         ret = CALL(m_lock.release());
@@ -427,9 +334,12 @@ public:
 
     /// @brief called by I2C handler asynchronously
     void callback(int) {
-        // all this does is set a flag
-        // the interrupt is actually "handled" in 'poll'
-        m_isr_flag = 1;
+        // hand the interrupt straight to the scheduler, the task waiting on
+        // the transfer is ready on the next dispatch
+        tid_t owner = m_owner;
+        if (-1 != owner) {
+            WAKE_ISR(owner);
+        }
     }
 
 private:
@@ -437,18 +347,18 @@ private:
     static const int TX_NUM = 0;
     static const int RX_NUM = 1;
 
-    // currently blocked task
-    tid_t m_blocked;
+    // task waiting for the current transfer to complete
+    WaitQueue m_done;
+
+    // task that started the current transfer, woken by the interrupt
+    // -1 if no transfer is waiting for an interrupt
+    volatile tid_t m_owner;
 
     // HAL I2C handle
     I2C_HandleTypeDef *m_i2c;
 
     // Device lock
     BlockingSemaphore m_lock;
-
-    // Flag when an interrupt has occurred
-    uint8_t m_isr_flag;
-
 };
 
 #endif
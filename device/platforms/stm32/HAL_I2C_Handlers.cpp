@@ -16,8 +16,8 @@ namespace HALHandlers {
 
 // hashmap that maps I2C devices to registered devices
 // uses the default XOR hash
-static alloc::Hashmap<I2C_HandleTypeDef*, dev_t, MAX_I2C_DEVICES, MAX_I2C_DEVICES> i2c_tx_map;
-static alloc::Hashmap<I2C_HandleTypeDef*, dev_t, MAX_I2C_DEVICES, MAX_I2C_DEVICES> i2c_rx_map;
+static alloc::Hashmap<I2C_HandleTypeDef*, dev_t, MAX_I2C_DEVICES> i2c_tx_map;
+static alloc::Hashmap<I2C_HandleTypeDef*, dev_t, MAX_I2C_DEVICES> i2c_rx_map;
 
 RetType register_i2c_tx(I2C_HandleTypeDef* hi2c, CallbackDevice* dev, int num) {
     if(i2c_tx_map[hi2c] != NULL) {
@@ -15,6 +15,7 @@
 #include "device/platforms/stm32/HAL_Handlers.h"
 #include "sched/sched.h"
 #include "sync/BlockingSemaphore.h"
+#include "sync/WaitQueue.h"
 #include "device/SPIDevice.h"
 
 /// @brief SPI device controller
@@ -25,10 +26,9 @@ public:
     /// @param h12c     the HAL SPI device wrapped by this device
     HALSPIDevice(const char *name, SPI_HandleTypeDef *hspi) : SPIDevice(name),
                                                               m_spi(hspi),
-                                                              m_blocked(-1),
-                                                              m_lock(1),
-                                                              m_isr_lock(1),
-                                                              m_isr_flag(0){};
+                                                              m_done(),
+                                                              m_owner(-1),
+                                                              m_lock(1) {};
 
     /// @brief initialize
     RetType init() {
@@ -60,35 +60,18 @@ public:
     }
 
     /// @brief poll this device
-    /// @return
+    ///        the interrupt at the end of a transfer wakes the waiting task
+    ///        through the scheduler, so there's nothing to poll
+    /// @return always successful
     RetType poll() {
-        // disable interrupts to protect access to 'm_isr_flag'
-        __disable_irq();
-
-        if (m_isr_flag) {
-            // an interrupt occurred
-
-            // reset the flag
-            m_isr_flag = 0;
-
-            // re-enable interrupts
-            __enable_irq();
-
-            // if a task was blocked waiting for completion of this ISR, wake it up
-            if(m_blocked != -1) {
-                WAKE(m_blocked);
-
-                // set this task as woken
-                m_blocked = -1;
-            }
-        } else {
-            // re-enable interrupts immediately
-            __enable_irq();
-        }
-
         return RET_SUCCESS;
     }
 
+    /// @brief nothing to poll, don't start a task for this device
+    poll_source_t poll_source() {
+        return POLL_NONE;
+    }
+
     /// @brief write to the SPI
     /// @param buff     the buffer to write
     /// @param len      the size of 'buff' in bytes
@@ -104,39 +87,21 @@ public:
             return ret;
         }
 
-        // mark this task as blocked BEFORE we call the interrupt function
-        // we want to make sure there is no race condition b/w processing the ISR
-        // and blocking the task
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // do our transmit
         if (HAL_OK != HAL_SPI_Transmit_IT(m_spi, buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if (0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if (m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
-
-        // mark the device as unblocked
-        m_blocked = -1;
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // we can unblock someone else if they were waiting
         ret = CALL(m_lock.release());
@@ -171,39 +136,21 @@ public:
             return ret;
         }
 
-        // mark this task as blocked BEFORE we call the interrupt function
-        // we want to make sure there is no race condition b/w processing the ISR
-        // and blocking the task
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_SPI_Receive_IT(m_spi, buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if (0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if (m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
-
-        // mark the device as unblocked
-        m_blocked = -1;
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
         // we can unblock someone else if they were waiting
         ret = CALL(m_lock.release());
@@ -229,45 +176,27 @@ public:
         RetType ret = CALL(m_lock.acquire());
         if (ret != RET_SUCCESS) {
             // some error
-            m_blocked = -1;
             CALL(m_lock.release());
             RESET();
             return ret;
         }
 
-        // mark this task as blocked BEFORE we call the interrupt function
-        // we want to make sure there is no race condition b/w processing the ISR
-        // and blocking the task
-        m_blocked = sched_dispatched;
+        // the interrupt at the end of the transfer wakes this task
+        m_owner = sched_dispatched;
 
         // start the transfer
         if (HAL_OK != HAL_SPI_TransmitReceive_IT(m_spi, write_buff, read_buff, len)) {
-            m_blocked = -1;
+            m_owner = -1;
             CALL(m_lock.release());
             RESET();
             return RET_ERROR;
         }
 
         // block and wait for the transfer to complete
-        bool timed_out;
-        if (0 == timeout) {
-            BLOCK();
-            timed_out = false;
-        } else {
-            SLEEP(timeout);
-
-            // if the ISR didn't occur, the operation timed out
-            // 'm_blocked' is only reset in poll, so if it's still the task TID
-            // the interrupt never occurred before this task woke up
-            if (m_blocked != -1) {
-                timed_out = true;
-            } else {
-                timed_out = false;
-            }
-        }
+        // the interrupt wakes us, or we time out if it never occurs
+        bool timed_out = (RET_TIMEOUT == CALL(m_done.wait(timeout)));
+        m_owner = -1;
 
-        // mark the device as unblocked
-        m_blocked = -1;
         // we can unblock someone else if they were waiting
         ret = CALL(m_lock.release());
         if (ret != RET_SUCCESS) {
@@ -287,17 +216,24 @@ public:
 
     /// @brief called by SPI handler asynchronously
     void callback(int) {
-        // all this does is set a flag
-        // the interrupt is actually "handled" in 'poll'
-        m_isr_flag = 1;
+        // hand the interrupt straight to the scheduler, the task waiting on
+        // the transfer is ready on the next dispatch
+        tid_t owner = m_owner;
+        if (-1 != owner) {
+            WAKE_ISR(owner);
+        }
     }
 
 private:
     // HAL handle
     SPI_HandleTypeDef *m_spi;
 
-    // current blocked task
-    tid_t m_blocked;
+    // task waiting for the current transfer to complete
+    WaitQueue m_done;
+
+    // task that started the current transfer, woken by the interrupt
+    // -1 if no transfer is waiting for an interrupt
+    volatile tid_t m_owner;
 
     // semaphore
     BlockingSemaphore m_lock;
@@ -306,10 +242,6 @@ private:
     // unique numbers for tx vs. rx callback
     static const int TX_NUM = 0;
     static const int RX_NUM = 1;
-
-    // Flag when an interrupt has occurred
-    Semaphore m_isr_lock;
-    uint8_t m_isr_flag;
 };
 
 #endif
@@ -16,8 +16,8 @@ namespace HALHandlers {
 
 // hashmap that maps SPI devices to registered devices
 // uses the default XOR hash
-static alloc::Hashmap<SPI_HandleTypeDef*, dev_t, MAX_SPI_DEVICES, MAX_SPI_DEVICES> spi_tx_map;
-static alloc::Hashmap<SPI_HandleTypeDef*, dev_t, MAX_SPI_DEVICES, MAX_SPI_DEVICES> spi_rx_map;
+static alloc::Hashmap<SPI_HandleTypeDef*, dev_t, MAX_SPI_DEVICES> spi_tx_map;
+static alloc::Hashmap<SPI_HandleTypeDef*, dev_t, MAX_SPI_DEVICES> spi_rx_map;
 
 RetType register_spi_tx(SPI_HandleTypeDef* hspi, CallbackDevice* dev, int num) {
     if(spi_tx_map[hspi] != NULL) {
@@ -10,7 +10,7 @@
 #include "device/StreamDevice.h"
 #include "device/platforms/stm32/HAL_Handlers.h"
 #include "sched/macros.h"
-#include "ringbuffer/RingBuffer.h"
+#include "ringbuffer/SPSCRing.h"
 #include "sync/BlockingSemaphore.h"
 
 /// @brief HAL UART device
@@ -25,8 +25,10 @@ public:
                                                                  m_uart(huart),
                                                                  m_lock(1),
                                                                  m_blocked(-1),
-                                                                 m_waiting(false),
-                                                                 m_isr_flag(0) {};
+                                                                 m_isr_flag(0) {
+        // the receive interrupt wakes the reader once it has enough data
+        m_buff.on_threshold(&rx_ready, this);
+    };
 
     /// @brief initialize
     RetType init() {
@@ -63,6 +65,7 @@ public:
     }
 
     /// @brief poll this device
+    ///        only polled after the transmit complete interrupt requests it
     /// @return
     RetType poll() {
         // disable interrupts to protect access to 'm_isr_flag'
@@ -92,6 +95,11 @@ public:
         return RET_SUCCESS;
     }
 
+    /// @brief only poll after an interrupt
+    poll_source_t poll_source() {
+        return POLL_EVENT;
+    }
+
     /// @brief write to the UART
     /// @param buff     the buffer to write
     /// @param len      the size of 'buff' in bytes
@@ -161,7 +169,7 @@ public:
         ret = CALL(wait(len));
         if (ret == RET_SUCCESS) {
             // read the data
-            if (len != m_buff.pop(buff, len)) {
+            if (len != m_buff.read(buff, len)) {
                 ret = RET_ERROR;
             }
         }
@@ -191,7 +199,6 @@ public:
     RetType wait(size_t len) {
         RESUME();
 
-        m_waiting = len;
         m_blocked = sched_dispatched;
 
         // block the task, even if it might not need to be blocked
@@ -199,16 +206,11 @@ public:
         // we get an interrupt in between the check and block, so our task may sleep forever
         sched_block(sched_dispatched);
 
-        // check for one of two cases
-        //  1. We already had enough data buffered to read, there was no need to block at all
-        //  2. We got an interrupt after setting m_waiting or m_blocked that filled the buffer up, we don't need to block
-        // any other case means the buffer is too small and we should block
-        // we don't need to worry if we get an interrupt b/w when we check the size
-        // and when we yield back to the scheduler, our task is already recorded and
-        // the callback handler will wake us (or we may already be woken by the time the function exits)
-
-        if (m_buff.size() >= len) {
-            // either case 1 or 2 occured, so we can just wake our task and be done
+        // ask the receive interrupt to wake us once there's enough data
+        // if there already is, we don't need to block at all
+        // if the interrupt got there first it has queued our wake, so we
+        // yield below and take it rather than leave it to wake us later
+        if (m_buff.threshold(len)) {
             sched_wake(sched_dispatched);
 
             RESET();
@@ -220,7 +222,7 @@ public:
         // so we just need to give execution back to the scheduler at this point
         YIELD();
 
-        // if we made it here, we got enough data and the callback woke us up
+        // if we made it here, we got enough data and the interrupt woke us up
         // oh yeah
 
         RESET();
@@ -229,14 +231,14 @@ public:
 
 private:
     // TODO not sure what size this should be yet
-    alloc::RingBuffer<256, true> m_buff;
+    // written by the receive interrupt, read by tasks, no locking needed
+    alloc::SPSCRing<256> m_buff;
 
     UART_HandleTypeDef *m_uart; // HAL handler
 
     BlockingSemaphore m_lock; // semaphore
 
     tid_t m_blocked;  // currently blocked task
-    size_t m_waiting; // amount of data the blocked task is waiting for (if rx)
 
     // single byte to read into
     uint8_t m_byte;
@@ -254,17 +256,12 @@ private:
             // all this does is set a flag
             // the interrupt is actually "handled" in 'poll'
             m_isr_flag = 1;
+            poll_request();
         } else {
             // we received some data into 'm_byte'
-            m_buff.push(&m_byte, sizeof(uint8_t)); // don't error check
-
-            // if someone is blocked on reading, see if we can now unblock them
-            if (m_blocked == -1) {
-                if (m_buff.size() >= m_waiting) {
-                    // someone was waiting, wake them up now
-                    WAKE(m_blocked);
-                }
-            }
+            // if someone is blocked on reading and this was enough, 'rx_ready'
+            // wakes them
+            m_buff.write(&m_byte, sizeof(uint8_t)); // dropped if full
 
             // start another read
             HAL_UART_Receive_IT(m_uart, &m_byte, sizeof(uint8_t));
@@ -272,6 +269,13 @@ private:
 
         return;
     }
+
+    /// @brief called from the receive interrupt when a blocked reader has
+    ///        enough data
+    static void rx_ready(void* arg) {
+        HALUARTDevice* dev = reinterpret_cast<HALUARTDevice*>(arg);
+        WAKE_ISR(dev->m_blocked);
+    }
 };
 
 #endif
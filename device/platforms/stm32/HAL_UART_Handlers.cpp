@@ -15,8 +15,8 @@ namespace HALHandlers {
 
 // hashmap that maps UART devices to registered devices
 // uses the default XOR hash
-static alloc::Hashmap<UART_HandleTypeDef*, dev_t, MAX_UART_DEVICES, MAX_UART_DEVICES> uart_tx_map;
-static alloc::Hashmap<UART_HandleTypeDef*, dev_t, MAX_UART_DEVICES, MAX_UART_DEVICES> uart_rx_map;
+static alloc::Hashmap<UART_HandleTypeDef*, dev_t, MAX_UART_DEVICES> uart_tx_map;
+static alloc::Hashmap<UART_HandleTypeDef*, dev_t, MAX_UART_DEVICES> uart_rx_map;
 
 RetType register_uart_tx(UART_HandleTypeDef* huart, CallbackDevice* dev, int num) {
     if(uart_tx_map[huart] != NULL) {
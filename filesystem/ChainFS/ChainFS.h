@@ -134,7 +134,8 @@ public:
         }
 
         // allocate a file descriptor for this file
-        static int* fd_ptr;
+        static int fd_num;
+        int* fd_ptr;
         fd_ptr = m_queue.peek();
 
         if(NULL == fd_ptr) {
@@ -142,6 +143,8 @@ public:
             return RET_ERROR;
         }
 
+        // copy it before popping, the queue frees it's node back to a pool
+        fd_num = *fd_ptr;
         m_queue.pop();
 
         static name_descriptor_t* name_desc;
@@ -232,7 +235,7 @@ public:
 
         // initialize parameters in file descriptor block
         static File_t* file;
-        file = &(m_files[*fd_ptr]);
+        file = &(m_files[fd_num]);
 
         file->name_block = block;
         file->read_offset = 0;
@@ -296,7 +299,7 @@ public:
 out:
         // put this file descriptor back on the queue if we failed to open
         if(ret != RET_SUCCESS) {
-            m_queue.push(*fd);
+            m_queue.push(fd_num);
         } else {
             // mark the file as successfully opened!
             file->open = true;
@@ -304,7 +307,7 @@ out:
 
         // TODO unlock FS
 
-        *fd = *fd_ptr;
+        *fd = fd_num;
 
         RESET();
         return ret;
@@ -4,6 +4,14 @@
 *
 *  Purpose: Contains definition for a hash object and some common hashes.
 *
+*           Hash functions:
+*               'hash_mix'      multiply-xorshift mixer for integers and pointers
+*               'hash_fnv1a'    FNV-1a for strings and short byte arrays
+*               'hash_bytes'    bulk hash for larger objects, a word at a time
+*           Functors wrapping them can be passed as the hash template parameter
+*           of containers (e.g. Hashmap), where they're called directly so they
+*           inline. 'DefaultHash' picks one for a type with 'HashTraits'.
+*
 *  Author: Will Merges
 *
 *  RIT Launch Initiative
@@ -13,6 +21,8 @@
 #define HASH_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 
 /// @brief hash interface
 /// @tparam T   the object type to be hashed
@@ -33,7 +43,287 @@ public:
     }
 };
 
+/// @brief mix a 64 bit integer so every input bit affects every output bit
+///        (splitmix64 finalizer)
+constexpr uint64_t hash_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
+/// @brief mix a 32 bit integer so every input bit affects every output bit
+///        (lowbias32)
+constexpr uint32_t hash_mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352DUL;
+    x ^= x >> 15;
+    x *= 0x846CA68BUL;
+    x ^= x >> 16;
+
+    return x;
+}
+
+/// @brief mix an integer the width of 'size_t'
+constexpr size_t hash_mix(size_t x) {
+    return (sizeof(size_t) > 4) ? (size_t)hash_mix64(x) : (size_t)hash_mix32((uint32_t)x);
+}
+
+/// @brief hash bytes with FNV-1a, one byte at a time
+///        best for short keys, usable at compile time
+constexpr size_t hash_fnv1a(const uint8_t* data, size_t len) {
+    size_t hash = (sizeof(size_t) > 4) ? (size_t)14695981039346656037ULL : (size_t)2166136261UL;
+
+    for(size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= (sizeof(size_t) > 4) ? (size_t)1099511628211ULL : (size_t)16777619UL;
+    }
+
+    return hash;
+}
+
+/// @brief hash a null terminated string with FNV-1a
+///        usable at compile time, e.g. to hash string literals
+constexpr size_t hash_fnv1a(const char* str) {
+    size_t hash = (sizeof(size_t) > 4) ? (size_t)14695981039346656037ULL : (size_t)2166136261UL;
+
+    for(size_t i = 0; str[i]; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= (sizeof(size_t) > 4) ? (size_t)1099511628211ULL : (size_t)16777619UL;
+    }
+
+    return hash;
+}
+
+namespace hash_internal {
+
+// helper functions to read unaligned little endian words
+static inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// multiply and fold the high half of the product into the low half
+static inline uint64_t mum(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    // no 128 bit type, build the product from 32 bit halves
+    uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    uint64_t hi_hi = (a >> 32) * (b >> 32);
+
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    uint64_t lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+
+    return lo ^ hi;
+#endif
+}
+
+static inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static const uint64_t P0 = 0xA0761D6478BD642FULL;
+static const uint64_t P1 = 0xE7037ED1A0B428DBULL;
+
+static const uint32_t Q0 = 0x9E3779B1UL;
+static const uint32_t Q1 = 0x85EBCA77UL;
+static const uint32_t Q2 = 0xC2B2AE3DUL;
+
+}
+
+/// @brief bulk hash, 16 bytes per multiply (wyhash style)
+///        for 64 bit targets with a fast 64x64 bit multiply
+static inline uint64_t hash_bytes64(const void* data, size_t len, uint64_t seed = 0) {
+    using namespace hash_internal;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    uint64_t s = seed ^ mum(seed ^ P0, P1);
+    uint64_t a;
+    uint64_t b;
+
+    if(len <= 16) {
+        if(len >= 4) {
+            // two reads from each end cover every byte, maybe overlapping
+            size_t mid = (len >> 3) << 2;
+            a = ((uint64_t)read32(p) << 32) | read32(p + mid);
+            b = ((uint64_t)read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+        } else if(len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = len;
+
+        while(i > 16) {
+            s = mum(read64(p) ^ P1, read64(p + 8) ^ s);
+            p += 16;
+            i -= 16;
+        }
+
+        // the last 16 bytes, maybe overlapping what was already hashed
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    return mum(P1 ^ len, mum(a ^ P1, b ^ s));
+}
+
+/// @brief bulk hash, 4 bytes per multiply (xxhash32 style)
+///        for 32 bit targets
+static inline uint32_t hash_bytes32(const void* data, size_t len, uint32_t seed = 0) {
+    using namespace hash_internal;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    uint32_t h = seed + Q0 + (uint32_t)len;
+    size_t i = 0;
+
+    for(; i + 4 <= len; i += 4) {
+        h = rotl32(h + read32(p + i) * Q1, 13) * Q0;
+    }
+
+    for(; i < len; i++) {
+        h = rotl32(h + p[i] * Q2, 11) * Q0;
+    }
+
+    // avalanche
+    h ^= h >> 15;
+    h *= Q1;
+    h ^= h >> 13;
+    h *= Q2;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/// @brief bulk hash using the best version for the target
+static inline size_t hash_bytes(const void* data, size_t len, size_t seed = 0) {
+    if(sizeof(size_t) > 4) {
+        return (size_t)hash_bytes64(data, len, seed);
+    }
+
+    return (size_t)hash_bytes32(data, len, (uint32_t)seed);
+}
+
+/// @brief picks how an object type is hashed, by default its bytes with
+///        'hash_bytes'
+///        types with padding should specialize this, padding bytes can differ
+///        between objects that compare equal
+/// @tparam T   the object type to be hashed
+template <typename T>
+struct HashTraits {
+    static inline size_t hash(const T& obj) {
+        return hash_bytes(&obj, sizeof(T));
+    }
+};
+
+/// @brief integers are mixed
+#define HASH_TRAITS_INT(TYPE)                                                   \
+template <>                                                                     \
+struct HashTraits<TYPE> {                                                       \
+    static constexpr size_t hash(const TYPE& obj) {                             \
+        return (sizeof(TYPE) > sizeof(size_t)) ? (size_t)hash_mix64((uint64_t)obj) \
+                                               : hash_mix((size_t)obj);         \
+    }                                                                           \
+};
+
+HASH_TRAITS_INT(bool)
+HASH_TRAITS_INT(char)
+HASH_TRAITS_INT(signed char)
+HASH_TRAITS_INT(unsigned char)
+HASH_TRAITS_INT(short)
+HASH_TRAITS_INT(unsigned short)
+HASH_TRAITS_INT(int)
+HASH_TRAITS_INT(unsigned int)
+HASH_TRAITS_INT(long)
+HASH_TRAITS_INT(unsigned long)
+HASH_TRAITS_INT(long long)
+HASH_TRAITS_INT(unsigned long long)
+
+#undef HASH_TRAITS_INT
+
+/// @brief pointers are mixed by address, the same way they compare
+///        use 'StringHash' to hash strings by contents
+template <typename T>
+struct HashTraits<T*> {
+    static inline size_t hash(T* const& obj) {
+        return hash_mix(reinterpret_cast<size_t>(obj));
+    }
+};
+
+/// @brief hashes an object the way 'HashTraits' picks for its type
+/// @tparam T   the object type to be hashed
+template <typename T>
+class DefaultHash {
+public:
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t hash(const T& obj) const {
+        return HashTraits<T>::hash(obj);
+    }
+
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t operator()(const T& obj) const {
+        return HashTraits<T>::hash(obj);
+    }
+};
+
+/// @brief hashes an object's bytes with FNV-1a
+/// @tparam T   the object type to be hashed
+template <typename T>
+class FNV1aHash {
+public:
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t hash(const T& obj) const {
+        return hash_fnv1a(reinterpret_cast<const uint8_t*>(&obj), sizeof(T));
+    }
+
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t operator()(const T& obj) const {
+        return hash(obj);
+    }
+};
+
+/// @brief hashes an object's bytes with 'hash_bytes'
+/// @tparam T   the object type to be hashed
+template <typename T>
+class BytesHash {
+public:
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t hash(const T& obj) const {
+        return hash_bytes(&obj, sizeof(T));
+    }
+
+    /// @brief calculate the hash
+    /// @return the hash
+    inline size_t operator()(const T& obj) const {
+        return hash(obj);
+    }
+};
+
 /// @brief hashes an object using a basic XOR
+///        cheap, but only as good as the object's words are different
 /// @tparam T   the object type to be hashed
 template <typename T>
 class XORHash : public Hash<T> {
@@ -46,43 +336,33 @@ public:
         size_t hash = 0;
         const uint8_t* data8 = reinterpret_cast<const uint8_t*>(&obj);
 
-        // get to an offset of the output len
-        size_t start = sizeof(T) % sizeof(size_t);
-        for(size_t i = 0; i < start; i++) {
-            hash ^= (data8[i]);
+        // hash whole words
+        size_t i = 0;
+        for(; i + sizeof(size_t) <= sizeof(T); i += sizeof(size_t)) {
+            size_t word;
+            memcpy(&word, data8 + i, sizeof(size_t));
+            hash ^= word;
         }
 
-        // hash the rest using the output len size
-        const size_t* data = reinterpret_cast<const size_t*>(&obj + start);
-        for(size_t i = 0; i < (sizeof(T) / sizeof(size_t)); i++) {
-            hash ^= data[i];
+        // then the rest, each byte kept in its place in the word
+        for(; i < sizeof(T); i++) {
+            hash ^= ((size_t)data8[i]) << ((i % sizeof(size_t)) * 8);
         }
 
         return hash;
     }
 };
 
-/// @brief hash a C-style string
-class StringHash : public Hash<char*> {
+/// @brief hash a C-style string by contents with FNV-1a
+class StringHash : public Hash<const char*> {
+public:
     /// @brief constructor
-    StringHash();
+    StringHash() {};
 
     /// @brief return a hash of the string
     /// @return the hash
-    size_t hash(const char*& obj) {
-        size_t hash = 0;
-        size_t i = 0;
-        size_t ii = 0;
-
-        while(obj[i]) {
-            hash ^= (((size_t)obj[i]) << (ii * 8));
-            i++;
-
-            ii++;
-            i %= sizeof(hash);
-        }
-
-        return hash;
+    size_t hash(const char* const& obj) {
+        return hash_fnv1a(obj);
     }
 };
 
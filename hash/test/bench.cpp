@@ -0,0 +1,191 @@
+// benchmarks how well each hash spreads the key sets the network stack uses,
+// UDP ports, IPv4 addresses, and NetworkLayer pointers, and what that costs
+//
+// for each key set and hash, reports:
+//  dropped     keys that didn't fit inserting 64 keys into 9 buckets of 8, the
+//              layout the old bucketed Hashmap used
+//  max         the fullest of 128 buckets picked by the low bits of the hash
+//  lookup      time per hit in a 64 key alloc::Hashmap
+//  bloom fp    false positive rate of a 1024 bit BloomFilter holding all 64
+//              keys, the filter remixes the hash to pick its bits so this only
+//              shows keys with equal hashes and blocks picked unevenly by the
+//              low bits
+//  hash        time per hash
+//
+// build: g++ -O2 -I../.. bench.cpp -o bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "hash/hash.h"
+#include "hashmap/hashmap.h"
+#include "bloom_filter/bloom_filter.h"
+#include "net/ipv4/ipv4.h"
+#include "net/network_layer/NetworkLayer.h"
+
+static const size_t N = 64;
+static const size_t LOOPS = 10000000;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// the previous XOR hash, 16 and 32 bit keys folded to 8 bits
+template <typename T>
+class OldXORHash {
+public:
+    size_t operator()(const T& obj) {
+        size_t hash = 0;
+        const uint8_t* data8 = reinterpret_cast<const uint8_t*>(&obj);
+
+        size_t start = sizeof(T) % sizeof(size_t);
+        for(size_t i = 0; i < start; i++) {
+            hash ^= (data8[i]);
+        }
+
+        // (the original offset '&obj' by 'start' objects, only safe when
+        // there are no whole words to read)
+        const size_t* data = reinterpret_cast<const size_t*>(data8 + start);
+        for(size_t i = 0; i < (sizeof(T) / sizeof(size_t)); i++) {
+            hash ^= data[i];
+        }
+
+        return hash;
+    }
+};
+
+// layers are only used for their addresses, sized like a real one
+class DummyLayer : public NetworkLayer {
+public:
+    RetType receive(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+    RetType transmit(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+    RetType transmit2(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+
+    uint8_t state[40];
+};
+
+static uint16_t rand_ports[2 * N];
+static uint16_t seq_ports[2 * N];
+static ipv4::IPv4Addr_t addrs[2 * N];
+static NetworkLayer* layers[2 * N];
+static DummyLayer layer_objs[2 * N];
+
+static volatile size_t sink;
+
+// keys [0, N) are inserted, keys [N, 2N) are never inserted
+template <typename T, typename HASH>
+void run(const char* name, T* keys) {
+    HASH hash;
+
+    // old bucket layout
+    size_t buckets[128] = {0};
+    size_t dropped = 0;
+    for(size_t i = 0; i < N; i++) {
+        if(buckets[hash(keys[i]) % 9]++ >= 8) {
+            dropped++;
+        }
+    }
+
+    // low bits
+    for(size_t i = 0; i < 128; i++) {
+        buckets[i] = 0;
+    }
+
+    size_t max = 0;
+    for(size_t i = 0; i < N; i++) {
+        size_t b = ++buckets[hash(keys[i]) & 127];
+        if(b > max) {
+            max = b;
+        }
+    }
+
+    // through the map
+    static alloc::Hashmap<T, uint32_t, N, HASH> map;
+    for(size_t i = 0; i < N; i++) {
+        map.remove(keys[i]);
+        map.add(keys[i]);
+    }
+
+    uint64_t start = now_ns();
+    size_t found = 0;
+    for(size_t i = 0; i < LOOPS; i++) {
+        if(map[keys[(i * 7) % N]]) {
+            found++;
+        }
+    }
+    double lookup_ns = (double)(now_ns() - start) / LOOPS;
+    sink = found;
+
+    // bloom filter
+    static alloc::BloomFilter<T, 1024, 7, HASH> bloom;
+    bloom.clear();
+    for(size_t i = 0; i < N; i++) {
+        bloom.encode(keys[i]);
+    }
+
+    size_t fp = 0;
+    for(size_t i = N; i < 2 * N; i++) {
+        if(bloom.present(keys[i])) {
+            fp++;
+        }
+    }
+
+    // raw hash
+    start = now_ns();
+    size_t acc = 0;
+    for(size_t i = 0; i < LOOPS; i++) {
+        acc += hash(keys[i % (2 * N)]);
+    }
+    double hash_ns = (double)(now_ns() - start) / LOOPS;
+    sink = acc;
+
+    printf("  %-14s %8lu %6lu %11.2f %9.0f%% %9.2f\n", name, dropped, max,
+           lookup_ns, 100.0 * fp / N, hash_ns);
+}
+
+template <typename T>
+void run_all(const char* keys_name, T* keys) {
+    printf("%s\n", keys_name);
+    run<T, OldXORHash<T>>("old XOR", keys);
+    run<T, XORHash<T>>("XOR", keys);
+    run<T, FNV1aHash<T>>("FNV-1a", keys);
+    run<T, BytesHash<T>>("bulk", keys);
+    run<T, DefaultHash<T>>("default", keys);
+}
+
+int main() {
+    srand(1);
+
+    for(size_t i = 0; i < 2 * N; i++) {
+        // random ephemeral ports, no repeats
+        bool repeat;
+        do {
+            rand_ports[i] = 49152 + rand() % 16384;
+
+            repeat = false;
+            for(size_t j = 0; j < i; j++) {
+                repeat |= (rand_ports[j] == rand_ports[i]);
+            }
+        } while(repeat);
+
+        // bound service ports, every 4th
+        seq_ports[i] = 8000 + 4 * i;
+
+        // a subnet of hosts, then a second subnet
+        ipv4::IPv4Address(10, 0, 1 + i / N, i % N + 10, &addrs[i]);
+
+        layers[i] = &(layer_objs[i]);
+    }
+
+    printf("  %-14s %8s %6s %11s %10s %9s\n", "hash", "dropped", "max",
+           "lookup (ns)", "bloom fp", "hash (ns)");
+
+    run_all("random ports", rand_ports);
+    run_all("service ports", seq_ports);
+    run_all("IPv4 addresses", addrs);
+    run_all("NetworkLayer*", layers);
+}
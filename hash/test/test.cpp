@@ -0,0 +1,170 @@
+// build: g++ -I../.. test.cpp -o test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "hash/hash.h"
+
+// usable at compile time
+static_assert(hash_fnv1a("") != hash_fnv1a("a"), "constexpr FNV-1a");
+static_assert(hash_mix(1) != hash_mix(2), "constexpr mix");
+static_assert(HashTraits<uint16_t>::hash(80) == hash_mix(80), "constexpr traits");
+
+bool fnv1a() {
+    // known vectors
+    if(sizeof(size_t) > 4) {
+        if(hash_fnv1a("a") != (size_t)0xAF63DC4C8601EC8CULL ||
+           hash_fnv1a("foobar") != (size_t)0x85944171F73967E8ULL) {
+            printf("bad 64 bit FNV-1a\n");
+            return false;
+        }
+    } else {
+        if(hash_fnv1a("a") != (size_t)0xE40C292CUL ||
+           hash_fnv1a("foobar") != (size_t)0xBF9CF968UL) {
+            printf("bad 32 bit FNV-1a\n");
+            return false;
+        }
+    }
+
+    const uint8_t bytes[] = {'f', 'o', 'o', 'b', 'a', 'r'};
+    if(hash_fnv1a(bytes, sizeof(bytes)) != hash_fnv1a("foobar")) {
+        printf("byte and string FNV-1a differ\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool xor_hash() {
+    XORHash<uint16_t> h16;
+    XORHash<uint32_t> h32;
+
+    // byte order matters
+    if(h16(0x1234) == h16(0x3412) || h32(0x01020304) == h32(0x04030201)) {
+        printf("XOR hash ignores byte order\n");
+        return false;
+    }
+
+    // every 16 bit key is different
+    static bool seen[0x10000];
+    for(uint32_t i = 0; i < 0x10000; i++) {
+        size_t h = h16(i) & 0xFFFF;
+        if(seen[h]) {
+            printf("16 bit keys collide\n");
+            return false;
+        }
+        seen[h] = true;
+    }
+
+    return true;
+}
+
+bool string_hash() {
+    StringHash h;
+
+    const char* a = "hello";
+    char b[] = "hello";
+    const char* c = "hellp";
+    const char* pb = b;
+
+    if(h(a) != h(pb)) {
+        printf("same string hashed differently\n");
+        return false;
+    }
+
+    if(h(a) == h(c)) {
+        printf("different strings hashed the same\n");
+        return false;
+    }
+
+    return true;
+}
+
+// checks that flipping any one input bit flips about half the output bits
+template <typename T, typename HASH>
+bool avalanche(const char* name) {
+    HASH h;
+    size_t flips = 0;
+    size_t tests = 0;
+
+    srand(1);
+    for(int n = 0; n < 1000; n++) {
+        T key;
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&key);
+        for(size_t i = 0; i < sizeof(T); i++) {
+            bytes[i] = rand();
+        }
+
+        size_t base = h(key);
+        for(size_t bit = 0; bit < sizeof(T) * 8; bit++) {
+            T flipped = key;
+            reinterpret_cast<uint8_t*>(&flipped)[bit / 8] ^= 1 << (bit % 8);
+
+            flips += __builtin_popcountll(base ^ h(flipped));
+            tests++;
+        }
+    }
+
+    double frac = (double)flips / tests / (sizeof(size_t) * 8);
+    if(frac < 0.45 || frac > 0.55) {
+        printf("%s flips %.2f of output bits\n", name, frac);
+        return false;
+    }
+
+    return true;
+}
+
+typedef struct {
+    uint8_t bytes[37];
+} blob_t;
+
+bool bytes_hash() {
+    uint8_t buff[64];
+    for(size_t i = 0; i < sizeof(buff); i++) {
+        buff[i] = i;
+    }
+
+    // every length hashes differently, including ones with the same bytes
+    for(size_t len = 0; len < sizeof(buff); len++) {
+        for(size_t other = 0; other < len; other++) {
+            if(hash_bytes(buff, len) == hash_bytes(buff, other) ||
+               hash_bytes32(buff, len) == hash_bytes32(buff, other)) {
+                printf("lengths %lu and %lu collide\n", len, other);
+                return false;
+            }
+        }
+    }
+
+    return avalanche<uint32_t, BytesHash<uint32_t>>("4 byte bulk hash") &&
+           avalanche<blob_t, BytesHash<blob_t>>("37 byte bulk hash") &&
+           avalanche<uint16_t, DefaultHash<uint16_t>>("16 bit mix") &&
+           avalanche<uint64_t, DefaultHash<uint64_t>>("64 bit mix") &&
+           avalanche<blob_t, DefaultHash<blob_t>>("default struct hash");
+}
+
+int main() {
+    if(fnv1a()) {
+        printf("passed FNV-1a test\n");
+    } else {
+        printf("failed FNV-1a test\n");
+    }
+
+    if(xor_hash()) {
+        printf("passed XOR hash test\n");
+    } else {
+        printf("failed XOR hash test\n");
+    }
+
+    if(string_hash()) {
+        printf("passed string hash test\n");
+    } else {
+        printf("failed string hash test\n");
+    }
+
+    if(bytes_hash()) {
+        printf("passed bulk hash test\n");
+    } else {
+        printf("failed bulk hash test\n");
+    }
+}
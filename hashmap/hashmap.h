@@ -4,6 +4,13 @@
 *
 *  Purpose: Contains implementation for a fixed sized hashmap.
 *
+*           Open addressing with Robin-Hood linear probing. Each entry holds
+*           how far it is from the slot it hashed to, inserts take the slot of
+*           any entry closer to home than the one being inserted, so probe
+*           lengths stay short and even at high load. Lookups stop as soon as
+*           they reach an entry closer to home than they are, and removes shift
+*           the following entries back instead of leaving tombstones.
+*
 *  Author: Will Merges
 *
 *  RIT Launch Initiative
@@ -22,6 +29,7 @@ namespace hashmap_internal {
 /// @brief hashmap internal entry type
 template <typename KEY, typename VALUE>
 struct entry_t {
+    uint16_t dist; // distance from the slot the key hashed to plus one, 0 if empty
     KEY key;
     VALUE val;
 };
@@ -31,70 +39,109 @@ struct entry_t {
 /// @brief hashmap
 /// @tparam KEY     the type of the keys in the hashmap
 /// @tparam VALUE   the type of values in the hashmap
-/// operations are O(BUCKET_SIZE)
-// TODO template the hash function? for now only XORHash is used
-template <typename KEY, typename VALUE>
+/// @tparam HASH    the hash to use for keys, called directly so it's inlined
+/// operations are O(1) expected
+/// NOTE: pointers to values are only valid until the next add or remove, both
+///       can move other entries
+template <typename KEY, typename VALUE, typename HASH = DefaultHash<KEY>>
 class Hashmap {
 public:
     /// @brief add a value to the map
     /// @param key  the key of the value
     /// @return a pointer to the value to be copied into, or NULL on error
-    /// NOTE: the way we add we don't look for collisions with other keys
-    /// the first key added will be returned by get until it is removed
+    ///         (the map is full or 'key' is already in it)
     VALUE* add(KEY key) {
-        size_t index = (m_hash.hash(key) % m_numBuckets) * m_bucketSize;
-
-        // find an unused location in this bucket
-        for(size_t i = index; i < index + m_bucketSize; i++) {
-            if(!m_used[i]) {
-                // this is our location!
-                m_entries[i].key = key;
-                m_used[i] = true;
-                return &(m_entries[i].val);
-            }
+        if(m_len >= m_max) {
+            return NULL;
         }
 
-        return NULL;
+        size_t i = home(key);
+        hashmap_internal::entry_t<KEY, VALUE> carry;
+        carry.dist = 1;
+        carry.key = key;
+        carry.val = VALUE();
+
+        VALUE* ret = NULL;
+
+        while(1) {
+            hashmap_internal::entry_t<KEY, VALUE>& entry = m_entries[i];
+
+            if(0 == entry.dist) {
+                // empty, done
+                entry = carry;
+
+                if(NULL == ret) {
+                    ret = &(entry.val);
+                }
+
+                m_len++;
+                return ret;
+            }
+
+            if(NULL == ret && entry.dist == carry.dist && entry.key == key) {
+                // a lookup of 'key' would stop here, it's already in the map
+                return NULL;
+            }
+
+            if(entry.dist < carry.dist) {
+                // this entry is closer to home than we are, take it's slot and
+                // keep going to find a new one for it
+                hashmap_internal::entry_t<KEY, VALUE> tmp = entry;
+                entry = carry;
+                carry = tmp;
+
+                if(NULL == ret) {
+                    // this is where our key stays
+                    ret = &(entry.val);
+                }
+            }
+
+            i = (i + 1) & m_mask;
+            carry.dist++;
+        }
     }
 
     /// @brief remove a value at a key
     /// @param key    the key of the value to remove
     /// @return 'true' if key was deleted, 'false' on error
     bool remove(KEY key) {
-        size_t index = (m_hash.hash(key) % m_numBuckets) * m_bucketSize;
-
-        // search this bucket for an entry with this key
-        for(size_t i = index; i < index + m_bucketSize; i++) {
-            if(m_used[i]) {
-                if(m_entries[i].key == key) {
-                    // we found it!
-                    m_used[i] = false;
-                    return true;
-                }
+        size_t i;
+
+        if(!find(key, &i)) {
+            // bad key
+            return false;
+        }
+
+        // shift back every following entry that isn't already home
+        while(1) {
+            size_t next = (i + 1) & m_mask;
+
+            if(m_entries[next].dist <= 1) {
+                break;
             }
+
+            m_entries[i] = m_entries[next];
+            m_entries[i].dist--;
+            i = next;
         }
 
-        // otherwise it's a bad key
-        return false;
+        m_entries[i].dist = 0;
+        m_len--;
+
+        return true;
     }
 
     /// @brief get the value at a key
     /// @param key  the key of the value
     /// @return a pointer to the value, or NULL on error (including key does not exist)
     VALUE* get(KEY key) {
-        size_t index = (m_hash.hash(key) % m_numBuckets) * m_bucketSize;
-
-        // search this bucket
-        for(size_t i = index; i < index + m_bucketSize; i++) {
-            if(m_used[i]) {
-                if(m_entries[i].key == key) {
-                    // we found it!
-                    return &(m_entries[i].val);
-                }
-            }
+        size_t i;
+
+        if(!find(key, &i)) {
+            return NULL;
         }
 
-        return NULL;
+        return &(m_entries[i].val);
     }
 
     /// @brief get the value at a key
@@ -104,57 +151,112 @@ public:
         return get(key);
     }
 
+    /// @brief get the number of values in the map
+    /// @return the number of values
+    size_t size() {
+        return m_len;
+    }
+
+    /// @brief get the most values the map can hold
+    /// @return the capacity
+    size_t capacity() {
+        return m_max;
+    }
+
 protected:
     /// @brief protected constructor, use alloc::Hashmap to declare instead
-    Hashmap(size_t num_buckets, size_t bucket_size,
-            hashmap_internal::entry_t<KEY, VALUE>* entries,
-            bool* used, Hash<KEY>& hash) :
-                                            m_numBuckets(num_buckets),
-                                            m_bucketSize(bucket_size),
-                                            m_entries(entries),
-                                            m_hash(hash),
-                                            m_used(used) {
-        for(size_t i = 0; i < num_buckets * bucket_size; i++) {
-            m_used[i] = false;
+    /// @param entries  storage for 'num_slots' entries
+    /// @param num_slots    a power of two greater than 'max'
+    /// @param max          the most values in the map
+    Hashmap(hashmap_internal::entry_t<KEY, VALUE>* entries,
+            size_t num_slots, size_t max) : m_entries(entries),
+                                            m_mask(num_slots - 1),
+                                            m_shift(sizeof(size_t) * 8),
+                                            m_len(0),
+                                            m_max(max),
+                                            m_hash() {
+        for(size_t i = 0; i < num_slots; i++) {
+            m_entries[i].dist = 0;
+        }
+
+        // keep log2(num_slots) bits of the mixed hash
+        for(size_t n = num_slots; n > 1; n >>= 1) {
+            m_shift--;
         }
     }
 
 private:
-    // size = num buckets X bucket size
-    size_t m_numBuckets;
-    size_t m_bucketSize;
+    // golden ratio constant for fibonacci hashing
+    static constexpr size_t FIB = (sizeof(size_t) > 4) ? (size_t)0x9E3779B97F4A7C15ULL
+                                                       : (size_t)0x9E3779B9UL;
+
+    // helper function to get the slot a key hashes to
+    // the hash is mixed and the top bits kept so weak hashes (e.g. aligned
+    // pointers or small integers) still spread over the table
+    inline size_t home(const KEY& key) {
+        return (m_hash(key) * FIB) >> m_shift;
+    }
+
+    // helper function to find the slot holding 'key'
+    bool find(const KEY& key, size_t* slot) {
+        size_t i = home(key);
+        uint16_t dist = 1;
+
+        while(1) {
+            hashmap_internal::entry_t<KEY, VALUE>& entry = m_entries[i];
+
+            if(entry.dist < dist) {
+                // empty, or closer to home than 'key' would be
+                return false;
+            }
+
+            if(entry.dist == dist && entry.key == key) {
+                *slot = i;
+                return true;
+            }
+
+            i = (i + 1) & m_mask;
+            dist++;
+        }
+    }
 
     hashmap_internal::entry_t<KEY, VALUE>* m_entries;
-    Hash<KEY>& m_hash;
+    size_t m_mask;
+    size_t m_shift;
+
+    size_t m_len;
+    size_t m_max;
 
-    bool* m_used;
+    HASH m_hash;
 };
 
 namespace alloc {
 
 /// @brief preallocated hashmap
-/// @tparam KEY           the type of keys in the hashmap
-/// @tparam value         the type of values in the hashmap
-/// @tparam NUM_BUCKETS   the number of buckets that can be stored in the map
-/// @tparam BUCKET_SIZE   the size of each bucket
-/// @tparam HASH          the hash to use for keys, defaults to basic XOR hash
-/// operations are O(BUCKET_SIZE)
-template <typename KEY, typename VALUE,
-          const size_t NUM_BUCKETS, const size_t BUCKET_SIZE,
-          typename HASH = XORHash<KEY>>
-class Hashmap : public ::Hashmap<KEY, VALUE> {
+/// @tparam KEY     the type of keys in the hashmap
+/// @tparam VALUE   the type of values in the hashmap
+/// @tparam SIZE    the most values in the map, storage is rounded up to a
+///                 power of two with at least an eighth of it left empty
+/// @tparam HASH    the hash to use for keys, defaults to the one 'HashTraits'
+///                 picks for the key type
+/// operations are O(1) expected
+template <typename KEY, typename VALUE, const size_t SIZE,
+          typename HASH = DefaultHash<KEY>>
+class Hashmap : public ::Hashmap<KEY, VALUE, HASH> {
 public:
     /// @brief constructor
-    Hashmap() : ::Hashmap<KEY, VALUE>(NUM_BUCKETS,
-                                      BUCKET_SIZE,
-                                      m_internalEntries,
-                                      m_internalUsed,
-                                      m_internalHash) {};
+    Hashmap() : ::Hashmap<KEY, VALUE, HASH>(m_internalEntries, SLOTS, SIZE) {};
 
 private:
-    hashmap_internal::entry_t<KEY, VALUE> m_internalEntries[NUM_BUCKETS * BUCKET_SIZE];
-    HASH m_internalHash;
-    bool m_internalUsed[NUM_BUCKETS * BUCKET_SIZE];
+    // smallest power of two that holds 'n' entries
+    static constexpr size_t table_size(size_t n) {
+        return (n <= 1) ? 1 : 2 * table_size((n + 1) / 2);
+    }
+
+    static constexpr size_t SLOTS = table_size(SIZE + SIZE / 8 + 1);
+    static_assert(SIZE > 0 && SLOTS <= 0xFFFF, "Hashmap size must fit in a 16 bit distance");
+
+    hashmap_internal::entry_t<KEY, VALUE> m_internalEntries[SLOTS];
 };
 
 }
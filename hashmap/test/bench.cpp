@@ -0,0 +1,179 @@
+// benchmarks the Robin-Hood hashmap against the bucketed implementation it
+// replaced, with the key types the network stack uses: UDP ports, IPv4
+// addresses, and NetworkLayer pointers
+// reports how many keys fit before the first failed add, and lookup times
+//
+// build: g++ -O2 -I../.. bench.cpp -o bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "hashmap/hashmap.h"
+#include "net/ipv4/ipv4.h"
+#include "net/network_layer/NetworkLayer.h"
+
+static const size_t LOOKUPS = 20000000;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// the previous implementation, fixed buckets and a virtual hash
+template <typename KEY, typename VALUE, size_t NUM_BUCKETS, size_t BUCKET_SIZE>
+class OldHashmap {
+public:
+    OldHashmap() : m_hash(m_xor) {
+        for(size_t i = 0; i < NUM_BUCKETS * BUCKET_SIZE; i++) {
+            m_used[i] = false;
+        }
+    }
+
+    VALUE* add(KEY key) {
+        size_t index = (m_hash.hash(key) % NUM_BUCKETS) * BUCKET_SIZE;
+
+        for(size_t i = index; i < index + BUCKET_SIZE; i++) {
+            if(!m_used[i]) {
+                m_entries[i].key = key;
+                m_used[i] = true;
+                return &(m_entries[i].val);
+            }
+        }
+
+        return NULL;
+    }
+
+    VALUE* get(KEY key) {
+        size_t index = (m_hash.hash(key) % NUM_BUCKETS) * BUCKET_SIZE;
+
+        for(size_t i = index; i < index + BUCKET_SIZE; i++) {
+            if(m_used[i]) {
+                if(m_entries[i].key == key) {
+                    return &(m_entries[i].val);
+                }
+            }
+        }
+
+        return NULL;
+    }
+
+private:
+    struct {
+        KEY key;
+        VALUE val;
+    } m_entries[NUM_BUCKETS * BUCKET_SIZE];
+    bool m_used[NUM_BUCKETS * BUCKET_SIZE];
+
+    XORHash<KEY> m_xor;
+    Hash<KEY>& m_hash;
+};
+
+// casts the key, a plain functor, inlined by the new map
+template <typename T>
+struct CastHash {
+    size_t operator()(const T& obj) {
+        return (size_t)obj;
+    }
+};
+
+// layers are only used for their addresses
+class DummyLayer : public NetworkLayer {
+public:
+    RetType receive(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+    RetType transmit(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+    RetType transmit2(Packet&, netinfo_t&, NetworkLayer*) { return RET_SUCCESS; }
+};
+
+static const size_t N = 64;
+
+static uint16_t ports[2 * N];
+static ipv4::IPv4Addr_t addrs[2 * N];
+static NetworkLayer* layers[2 * N];
+static DummyLayer layer_objs[2 * N];
+
+static volatile size_t sink;
+
+// fill the map with the first N keys, then look up the first N (hits) and the
+// second N (misses)
+template <typename MAP, typename KEY>
+void run(const char* name, MAP& map, KEY* keys) {
+    size_t fit = 0;
+    while(fit < N && map.add(keys[fit])) {
+        fit++;
+    }
+
+    double ns[2];
+    for(int miss = 0; miss < 2; miss++) {
+        size_t found = 0;
+
+        uint64_t start = now_ns();
+        for(size_t i = 0; i < LOOKUPS; i++) {
+            // only look up keys that made it in
+            size_t k = (i * 7) % fit;
+            if(map.get(keys[k + miss * N])) {
+                found++;
+            }
+        }
+        ns[miss] = (double)(now_ns() - start) / LOOKUPS;
+        sink = found;
+    }
+
+    printf("%-30s %8lu %10.2f %10.2f\n", name, fit, ns[0], ns[1]);
+}
+
+int main() {
+    srand(1);
+
+    for(size_t i = 0; i < 2 * N; i++) {
+        // random ephemeral ports, no repeats
+        bool repeat;
+        do {
+            ports[i] = 49152 + rand() % 16384;
+
+            repeat = false;
+            for(size_t j = 0; j < i; j++) {
+                repeat |= (ports[j] == ports[i]);
+            }
+        } while(repeat);
+
+        // a subnet of hosts, then a second subnet
+        ipv4::IPv4Address(192, 168, 1 + i / N, i % N + 10, &addrs[i]);
+
+        layers[i] = &(layer_objs[i]);
+    }
+
+    printf("%-30s %8s %10s %10s\n", "map (64 keys)", "fit", "hit (ns)", "miss (ns)");
+
+    // same storage as the new map, 8 slots per bucket
+    static OldHashmap<uint16_t, NetworkLayer*, 9, 8> old_port;
+    static OldHashmap<ipv4::IPv4Addr_t, NetworkLayer*, 9, 8> old_addr;
+    static OldHashmap<NetworkLayer*, uint16_t, 9, 8> old_layer;
+    run("old uint16_t port", old_port, ports);
+    run("old IPv4Addr_t", old_addr, addrs);
+    run("old NetworkLayer*", old_layer, layers);
+
+    // how the routers declared it, SIZE x SIZE slots
+    static OldHashmap<uint16_t, NetworkLayer*, N, N> big_port;
+    static OldHashmap<ipv4::IPv4Addr_t, NetworkLayer*, N, N> big_addr;
+    static OldHashmap<NetworkLayer*, uint16_t, N, N> big_layer;
+    run("old 64x64 uint16_t port", big_port, ports);
+    run("old 64x64 IPv4Addr_t", big_addr, addrs);
+    run("old 64x64 NetworkLayer*", big_layer, layers);
+
+    static alloc::Hashmap<uint16_t, NetworkLayer*, N> port;
+    static alloc::Hashmap<ipv4::IPv4Addr_t, NetworkLayer*, N> addr;
+    static alloc::Hashmap<NetworkLayer*, uint16_t, N> layer;
+    run("robin hood uint16_t port", port, ports);
+    run("robin hood IPv4Addr_t", addr, addrs);
+    run("robin hood NetworkLayer*", layer, layers);
+
+    static alloc::Hashmap<uint16_t, NetworkLayer*, N, CastHash<uint16_t>> cast_port;
+    static alloc::Hashmap<ipv4::IPv4Addr_t, NetworkLayer*, N, CastHash<ipv4::IPv4Addr_t>> cast_addr;
+    static alloc::Hashmap<NetworkLayer*, uint16_t, N, CastHash<NetworkLayer*>> cast_layer;
+    run("robin hood cast port", cast_port, ports);
+    run("robin hood cast IPv4Addr_t", cast_addr, addrs);
+    run("robin hood cast NetworkLayer*", cast_layer, layers);
+}
@@ -1,3 +1,5 @@
+// build: g++ -I../.. test.cpp -o test
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -5,7 +7,7 @@
 #include "hashmap/hashmap.h"
 
 bool basic() {
-    alloc::Hashmap<uint8_t, int, 5, 1> hm;
+    alloc::Hashmap<uint8_t, int, 5> hm;
 
     int* val = hm.add(1);
     *val = 10;
@@ -39,6 +41,127 @@ bool basic() {
         printf("get returning incorrect value\n");
         return false;
     }
+
+    return true;
+}
+
+bool full() {
+    alloc::Hashmap<uint16_t, uint16_t, 100> hm;
+
+    // ports, all of them must fit no matter how they hash
+    for(uint16_t i = 0; i < 100; i++) {
+        uint16_t* val = hm.add(8000 + i * 3);
+        if(val == NULL) {
+            printf("add failed at %u of 100\n", i);
+            return false;
+        }
+
+        *val = i;
+    }
+
+    if(hm.add(1)) {
+        printf("added past capacity\n");
+        return false;
+    }
+
+    for(uint16_t i = 0; i < 100; i++) {
+        uint16_t* val = hm[8000 + i * 3];
+        if(val == NULL || *val != i) {
+            printf("bad value for key %u\n", 8000 + i * 3);
+            return false;
+        }
+    }
+
+    if(hm[8001] || hm.remove(8001)) {
+        printf("found key that wasn't added\n");
+        return false;
+    }
+
+    return 100 == hm.size();
+}
+
+bool duplicate() {
+    alloc::Hashmap<uint32_t, int, 4> hm;
+
+    *hm.add(5) = 1;
+    if(hm.add(5)) {
+        printf("added the same key twice\n");
+        return false;
+    }
+
+    if(!hm.remove(5) || hm.remove(5)) {
+        printf("bad remove\n");
+        return false;
+    }
+
+    return hm.add(5) != NULL;
+}
+
+// every key hashes to the same slot
+class CollideHash : public Hash<uint32_t> {
+public:
+    size_t hash(const uint32_t&) {
+        return 0;
+    }
+};
+
+bool churn() {
+    alloc::Hashmap<uint32_t, uint32_t, 200, CollideHash> collide;
+    alloc::Hashmap<uint32_t, uint32_t, 200> spread;
+    bool in[1000] = {false};
+
+    srand(1);
+
+    // random adds and removes checked against a table of what should be in
+    for(int n = 0; n < 100000; n++) {
+        uint32_t key = rand() % 1000;
+        uint32_t* val;
+
+        if(in[key]) {
+            if(!collide.remove(key) || !spread.remove(key)) {
+                printf("failed to remove %u\n", key);
+                return false;
+            }
+
+            in[key] = false;
+        } else if(spread.size() < 200) {
+            val = collide.add(key);
+            if(val == NULL) {
+                printf("failed to add %u to colliding map\n", key);
+                return false;
+            }
+            *val = key * 2;
+
+            val = spread.add(key);
+            if(val == NULL) {
+                printf("failed to add %u\n", key);
+                return false;
+            }
+            *val = key * 2;
+
+            in[key] = true;
+        }
+
+        // spot check a few keys
+        for(int i = 0; i < 4; i++) {
+            uint32_t k = rand() % 1000;
+
+            uint32_t* a = collide[k];
+            uint32_t* b = spread[k];
+
+            if(in[k] != (a != NULL) || in[k] != (b != NULL)) {
+                printf("key %u %s\n", k, in[k] ? "missing" : "found after removed");
+                return false;
+            }
+
+            if(in[k] && (*a != k * 2 || *b != k * 2)) {
+                printf("bad value at key %u\n", k);
+                return false;
+            }
+        }
+    }
+
+    return true;
 }
 
 int main() {
@@ -47,4 +170,22 @@ int main() {
     } else {
         printf("basic test failed\n");
     }
+
+    if(full()) {
+        printf("full test passed\n");
+    } else {
+        printf("full test failed\n");
+    }
+
+    if(duplicate()) {
+        printf("duplicate test passed\n");
+    } else {
+        printf("duplicate test failed\n");
+    }
+
+    if(churn()) {
+        printf("churn test passed\n");
+    } else {
+        printf("churn test failed\n");
+    }
 }
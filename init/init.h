@@ -17,26 +17,49 @@
 #include "device/DeviceMap.h"
 #include "device/Device.h"
 
-/// @brief helper function to poll a device, essentially just calls the 'poll'
-///        function of 'dev'
+#ifdef __linux__
+#include "sched/platforms/linux/LinuxFdWake.h"
+#endif
+
+/// @brief helper function to poll a device, calls the 'poll' function of
+///        'dev' each time the device's poll source fires
+///         - POLL_CONTINUOUS devices are polled every time the task is dispatched
+///         - POLL_EVENT devices block until 'poll_request' is called (e.g. from
+///           an ISR) or until their 'poll_fd' is readable on Linux
+///         - POLL_PERIODIC devices sleep 'poll_period' ticks between polls
 /// @param dev     a Device class pointer to the device to poll
 /// @return
 RetType PollDevice(void *dev) {
-    RESUME();
+    Device *device = (Device *) dev;
 
-    // returns blocked or yield to return back to the scheduler
-    RetType ret = CALL(((Device *) dev)->poll());
+    RESUME();
 
-    // in cases where we get an error, don't want to stop handling the device.
-    // hopefully this doesn't happen, but if it does just pretend everything is
-    // fine so this task gets scheduled again.
-    if (RET_ERROR == ret) {
-        RESET();
-        return RET_SUCCESS;
+    while (1) {
+        // returns blocked or yield to return back to the scheduler
+        // in cases where we get an error, don't want to stop handling the
+        // device. hopefully this doesn't happen, but if it does just pretend
+        // everything is fine and wait to poll again.
+        CALL(device->poll());
+
+        if (POLL_EVENT == device->poll_source()) {
+#ifdef __linux__
+            int fd = device->poll_fd();
+
+            if (fd >= 0 && !linux_fd_arm(fd, sched_dispatched)) {
+                // can't wait on this descriptor, fall back to polling
+                YIELD();
+                continue;
+            }
+#endif
+            // a request made since we were last woken is queued, so it
+            // wakes us right away rather than being lost
+            BLOCK();
+        } else if (POLL_PERIODIC == device->poll_source()) {
+            SLEEP(device->poll_period());
+        } else {
+            YIELD();
+        }
     }
-
-    RESET();
-    return ret;
 }
 
 /// Argument passed to the init task
@@ -52,11 +75,12 @@ typedef struct {
 ///
 ///        What it does:
 ///         - for each device in the device map, it inits the device and then
-///           schedules a task to poll the device after it's inited.
+///           schedules a task to poll the device after it's inited, unless
+///           the device's poll source is POLL_NONE.
 ///         - it adds each task in the task list to the scheduler AFTER all
 ///           devices are init'd. These are the first 'user' tasks to run after
 ///           the board is initialized.
-///         - loops forever
+///         - exits, freeing its task
 ///
 /// @param init_args      the init arguments, an init_arg_t* cast to void*
 
@@ -71,11 +95,12 @@ RetType init(void *init_args) {
     while (nullptr != dev) {
         RetType ret = CALL(dev->init());
 
-        if (RET_SUCCESS == ret) {
+        if (RET_SUCCESS == ret && POLL_NONE != dev->poll_source()) {
             // add a handler for this device
             // NOTE: not checking the return here, nothing we can really do
             //       if it fails
             tid_t tid = sched_start(PollDevice, (void *) dev);
+            dev->set_poll_task(tid);
 #ifdef SWDEBUG_H
             swprintf("%s initialized with a TID of %d\n", dev->getName(), tid);
 #endif
@@ -95,8 +120,7 @@ RetType init(void *init_args) {
         sched_start(task, arg);
     }
 
-    // spin forever
-    while (1) {
-        YIELD();
-    };
+    // nothing left to do, exit rather than taking up a dispatch every loop
+    RESET();
+    return RET_ERROR;
 }
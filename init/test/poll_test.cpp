@@ -0,0 +1,261 @@
+// tests devices are only polled when their poll source fires, and compares how
+// many dispatches application tasks get with event driven vs. continuous
+// device polling
+//
+// build: g++ -pthread -I../.. ../../sched/sched.cpp ../../device/Device.cpp poll_test.cpp -o poll_test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include "sched/macros.h"
+#include "device/DeviceMap.h"
+#include "init/init.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+// device that counts how many times it's polled
+class CountDevice : public Device {
+public:
+    CountDevice(const char* name, poll_source_t source, uint32_t period = 0,
+                int fd = -1) : Device(name), polls(0), m_source(source),
+                               m_period(period), m_fd(fd) {};
+
+    RetType init() {
+        return RET_SUCCESS;
+    }
+
+    RetType poll() {
+        polls++;
+
+        if(m_fd >= 0) {
+            // drain the pipe so it isn't readable until written again
+            char c;
+            while(1 == read(m_fd, &c, 1)) {}
+        }
+
+        return RET_SUCCESS;
+    }
+
+    poll_source_t poll_source() {
+        return m_source;
+    }
+
+    uint32_t poll_period() {
+        return m_period;
+    }
+
+    int poll_fd() {
+        return m_fd;
+    }
+
+    // stop polling the device for the rest of the test
+    // its task blocks forever once it sees this
+    void stop() {
+        m_source = POLL_EVENT;
+        m_fd = -1;
+    }
+
+    int polls;
+
+private:
+    poll_source_t m_source;
+    uint32_t m_period;
+    int m_fd;
+};
+
+static const int NUM_BULK = 24;
+
+class TestMap : public alloc::DeviceMap<NUM_BULK> {
+public:
+    TestMap(CountDevice** devs, size_t num) : alloc::DeviceMap<NUM_BULK>("test map") {
+        for(size_t i = 0; i < num; i++) {
+            add(devs[i]->getName(), devs[i]);
+        }
+    }
+};
+
+// application task, counts how many times it's dispatched
+// exits once a later test starts a new one
+static int app_runs = 0;
+static size_t app_generation = 0;
+RetType app(void* arg) {
+    if((size_t)arg != app_generation) {
+        return RET_ERROR;
+    }
+
+    app_runs++;
+    return RET_SUCCESS;
+}
+
+static task_func_t app_tasks[] = {&app};
+static void* app_args[] = {NULL};
+
+// start init for a map with the app task, and run it until it's exited
+void start(DeviceMap* map) {
+    static init_arg_t args;
+    app_generation++;
+    app_args[0] = (void*)app_generation;
+    args.dev_map = map;
+    args.tasks = app_tasks;
+    args.args = app_args;
+    args.num_tasks = 1;
+
+    sched_start(&init, &args);
+    sched_dispatch();
+}
+
+double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+bool source_test() {
+    int fds[2];
+    if(0 != pipe2(fds, O_NONBLOCK)) {
+        printf("failed to create pipe\n");
+        return false;
+    }
+
+    CountDevice cont("continuous", POLL_CONTINUOUS);
+    CountDevice event("event", POLL_EVENT);
+    CountDevice periodic("periodic", POLL_PERIODIC, 5);
+    CountDevice none("none", POLL_NONE);
+    CountDevice fd("fd", POLL_EVENT, 0, fds[0]);
+
+    CountDevice* devs[] = {&cont, &event, &periodic, &none, &fd};
+    TestMap map(devs, 5);
+    start(&map);
+
+    // every device with a task is polled once when it starts
+    for(int i = 0; i < 100; i++) {
+        sched_dispatch();
+    }
+
+    bool pass = true;
+
+    if(cont.polls < 20 || event.polls != 1 || periodic.polls != 1 ||
+       none.polls != 0 || fd.polls != 1) {
+        printf("bad first polls: continuous %i, event %i, periodic %i, none %i, fd %i\n",
+               cont.polls, event.polls, periodic.polls, none.polls, fd.polls);
+        pass = false;
+    }
+
+    // a request polls the event device once
+    event.poll_request();
+    for(int i = 0; i < 10; i++) {
+        sched_dispatch();
+    }
+
+    if(event.polls != 2) {
+        printf("event device polled %i times after one request\n", event.polls);
+        pass = false;
+    }
+
+    // periodic device polled once every 5 ticks
+    for(int i = 0; i < 20; i++) {
+        tick++;
+        for(int j = 0; j < 5; j++) {
+            sched_dispatch();
+        }
+    }
+
+    if(periodic.polls != 5) {
+        printf("periodic device polled %i times in 20 ticks, expected 5\n", periodic.polls);
+        pass = false;
+    }
+
+    // writing the pipe polls the fd device
+    if(1 != write(fds[1], "x", 1)) {
+        printf("failed to write pipe\n");
+        return false;
+    }
+
+    double start_ms = now_ms();
+    while(fd.polls < 2 && now_ms() - start_ms < 1000) {
+        sched_dispatch();
+    }
+
+    if(fd.polls != 2) {
+        printf("fd device polled %i times after a write\n", fd.polls);
+        pass = false;
+    }
+
+    cont.stop();
+    periodic.stop();
+    fd.stop();
+    sched_dispatch();
+    sched_dispatch();
+    sched_dispatch();
+
+    close(fds[0]);
+    close(fds[1]);
+    return pass;
+}
+
+// share of dispatches the app task gets with 'NUM_BULK' idle devices
+double share_test(poll_source_t source) {
+    CountDevice* devs[NUM_BULK];
+
+    for(int i = 0; i < NUM_BULK; i++) {
+        devs[i] = new CountDevice("bulk", source);
+    }
+
+    TestMap map(devs, NUM_BULK);
+    start(&map);
+
+    // let every device get it's first poll
+    for(int i = 0; i < NUM_BULK; i++) {
+        sched_dispatch();
+    }
+
+    app_runs = 0;
+    for(int i = 0; i < 1000; i++) {
+        sched_dispatch();
+    }
+
+    double share = app_runs / 1000.0;
+
+    // stop the devices so they don't affect anything else
+    for(int i = 0; i < NUM_BULK; i++) {
+        devs[i]->stop();
+    }
+
+    for(int i = 0; i < NUM_BULK * 2; i++) {
+        sched_dispatch();
+    }
+
+    return share;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(source_test()) {
+        printf("passed poll source test\n");
+    } else {
+        printf("failed poll source test\n");
+    }
+
+    double event_share = share_test(POLL_EVENT);
+    double cont_share = share_test(POLL_CONTINUOUS);
+
+    printf("app task got %.1f%% of dispatches with %i event devices, %.1f%% with %i continuous devices\n",
+           event_share * 100, NUM_BULK, cont_share * 100, NUM_BULK);
+
+    // the app task is the only ready task if devices are event driven
+    if(event_share > 0.99 && cont_share < 0.1) {
+        printf("passed dispatch share test\n");
+    } else {
+        printf("failed dispatch share test\n");
+    }
+}
@@ -139,7 +139,9 @@ public:
 
         uint8_t* num_ptr = m_protNumMap.add(&layer);
         if(num_ptr == NULL) {
-            // unable to add
+            // unable to add, or this layer already handles another protocol
+            m_protMap.remove(protocol);
+            return RET_ERROR;
         }
 
         *num_ptr = protocol;
@@ -452,13 +454,13 @@ private:
 
     // stores incoming routes
     // maps addresses to a layer packets from that address should come in on
-    alloc::Hashmap<IPv4Addr_t, NetworkLayer*, SIZE, SIZE> m_incoming;
+    alloc::Hashmap<IPv4Addr_t, NetworkLayer*, SIZE> m_incoming;
 
     // maps higher level protocols to protocol numbers
-    alloc::Hashmap<uint8_t, NetworkLayer*, SIZE, SIZE> m_protMap;
+    alloc::Hashmap<uint8_t, NetworkLayer*, SIZE> m_protMap;
 
     // maps higher layers to protocol numbers
-    alloc::Hashmap<NetworkLayer*, uint8_t, SIZE, SIZE> m_protNumMap;
+    alloc::Hashmap<NetworkLayer*, uint8_t, SIZE> m_protNumMap;
 
     // the found route for a packet
     // stores information b/w transmit1 and transmit2
@@ -21,6 +21,12 @@
 *           the last device in the ring the frame is dropped to avoid routing
 *           circles.
 *
+*           Each frame also carries an ID picked by the device that sent it,
+*           every device remembers the IDs of the last frames it saw in a
+*           counting bloom filter and drops repeats, so a frame that makes it
+*           around the ring again (e.g. a device joined or left and the TTL is
+*           off) isn't passed up or retransmitted twice.
+*
 *           While the decision whether to drop or pass a frame on could be
 *           handled at the network layer (e.g. IPv4 with routing), this is a
 *           much simpler approach that allows for any network protocol to be
@@ -43,6 +49,9 @@
 #include "net/slip/slip.h"
 #include "net/packet/Packet.h"
 #include "sched/macros.h"
+#include "bloom_filter/bloom_filter.h"
+#include "queue/ring_queue.h"
+#include "hash/hash.h"
 
 
 class SLIPRingDevice : public NetworkLayer, public Device {
@@ -50,6 +59,7 @@ public:
     /// @brief header for a slip ring frame
     typedef struct {
         uint32_t ttl;
+        uint32_t id; // picked by the sender, opaque to everyone else
     } slip_ring_header_t;
 
     /// @brief initialize the device
@@ -95,8 +105,16 @@ public:
             return RET_SUCCESS;
         }
 
-        // check if the frame should be retransmitted
         slip_ring_header_t* hdr = (slip_ring_header_t*)buff->data;
+
+        if(m_seen.present(hdr->id)) {
+            // we've already seen this frame (or it's a false positive, rarely)
+            // drop it so it doesn't go around the ring again
+            return RET_SUCCESS;
+        }
+        remember(hdr->id);
+
+        // check if the frame should be retransmitted
         hdr->ttl--;
 
         if(hdr->ttl > 0) {
@@ -128,7 +146,7 @@ public:
     /// @return
     RetType transmit(Packet& packet, netinfo_t&, NetworkLayer*) {
         // allocate the header for the ring frame
-        slip_ring_header_t* hdr = m_packet.allocate_header<slip_ring_header_t>();
+        slip_ring_header_t* hdr = packet.allocate_header<slip_ring_header_t>();
         if(NULL == hdr) {
             // no room :(
             return RET_ERROR;
@@ -150,10 +168,21 @@ public:
         packet.seek_read(true);
 
         uint8_t* ptr = packet.read_ptr<uint8_t>();
-        if(NULL == ptr) {
+        if(NULL == ptr || packet.available() < sizeof(slip_ring_header_t)) {
             return RET_ERROR;
         }
 
+        // pick an ID from the payload and how many frames we've sent, two
+        // devices would have to send the same payload as their same numbered
+        // frame to pick the same ID
+        slip_ring_header_t* hdr = (slip_ring_header_t*)ptr;
+        hdr->id = (uint32_t)hash_bytes(ptr + sizeof(slip_ring_header_t),
+                                       packet.available() - sizeof(slip_ring_header_t),
+                                       m_sent++);
+
+        // if it comes back around, drop it
+        remember(hdr->id);
+
         slip_buffer_t* buff = m_encoder.encode(ptr, packet.available());
         if(NULL == buff) {
             // failed to encode
@@ -177,20 +206,43 @@ protected:
     /// @param packet   an allocated packet
     /// @param encoder  SLIP encoder
     /// @param decoder  SLIP decoder
+    /// @param seen     filter of recently seen frame IDs
+    /// @param recent   queue of recently seen frame IDs, oldest first
     SLIPRingDevice(size_t size,
                    StreamDevice& serial,
                    NetworkLayer& net,
                    Packet& packet,
                    UnallocatedSLIPEncoder& encoder,
-                   UnallocatedSLIPDecoder& decoder)  : m_size(size),
-                                                       m_serial(serial),
-                                                       m_net(net),
-                                                       m_packet(packet),
-                                                       m_encoder(encoder),
-                                                       m_decoder(decoder),
-                                                ::Device("SLIP ring device") {};
+                   UnallocatedSLIPDecoder& decoder,
+                   CountingBloomFilter<uint32_t>& seen,
+                   Queue<uint32_t>& recent)  : m_size(size),
+                                               m_serial(serial),
+                                               m_net(net),
+                                               m_packet(packet),
+                                               m_encoder(encoder),
+                                               m_decoder(decoder),
+                                               m_seen(seen),
+                                               m_recent(recent),
+                                               m_sent(0),
+                                        ::Device("SLIP ring device") {};
 
 private:
+    // helper function to remember a frame ID, forgetting the oldest one if
+    // we're already remembering as many as we can
+    void remember(uint32_t id) {
+        if(NULL == m_recent.push(id)) {
+            uint32_t* oldest = m_recent.peek();
+            if(NULL != oldest) {
+                m_seen.remove(*oldest);
+                m_recent.pop();
+            }
+
+            m_recent.push(id);
+        }
+
+        m_seen.encode(id);
+    }
+
     // number of devices in the ring
     size_t m_size;
 
@@ -208,13 +260,23 @@ private:
 
     // decoder
     UnallocatedSLIPDecoder& m_decoder;
+
+    // IDs of recent frames
+    CountingBloomFilter<uint32_t>& m_seen;
+    Queue<uint32_t>& m_recent;
+
+    // number of frames sent, to pick IDs
+    uint32_t m_sent;
 };
 
 namespace alloc {
 
 /// @brief SLIPRingDevice with preallocated buffers
 /// @tparam SIZE    the maximum size of a packet to be encoded
-template <const size_t SIZE>
+/// @tparam WINDOW  the number of recent frames to drop repeats of
+///                 takes about 12 bytes per frame, with a false positive
+///                 (good frame dropped) rate under 1%
+template <const size_t SIZE, const size_t WINDOW = 512>
 class SLIPRingDevice : public ::SLIPRingDevice {
 public:
     /// @brief protected constructor
@@ -223,12 +285,16 @@ public:
     /// @param net      the network layer to pass received frames to
     SLIPRingDevice(size_t size, StreamDevice& serial, NetworkLayer& net) :
                                              ::SLIPRingDevice(size, serial, net,
-                                               packet, m_encoder, m_decoder) {};
+                                               packet, m_encoder, m_decoder,
+                                               m_seen, m_recent) {};
 
 private:
     SLIPEncoder<(SIZE + 1) * 2> m_encoder;
     SLIPDecoder<(SIZE + 1) * 2> m_decoder;
     Packet<SIZE, 0> packet;
+
+    CountingBloomFilter<uint32_t, WINDOW * 16> m_seen;
+    RingQueue<uint32_t, WINDOW> m_recent;
 };
 
 }
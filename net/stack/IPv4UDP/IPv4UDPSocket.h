@@ -23,10 +23,11 @@
 #include "net/eth/EthLayer.h"
 #include "return.h"
 #include "net/network_layer/NetworkLayer.h"
-#include "queue/allocated_queue.h"
+#include "queue/ring_queue.h"
 #include "net/packet/Packet.h"
 #include "pool/pool.h"
 #include "sched/macros.h"
+#include "sync/WaitQueue.h"
 
 // TODO add subscribing to multicast address somehow
 //      maybe just bind to multicast address (or 0.0.0.0)
@@ -147,41 +148,27 @@ public:
     /// buffered. Then fills in at most 'len' bytes to 'buff'. 'len' is set
     /// to the actual number of bytes in the packet, whether greater or less
     /// than the size of 'buff'. If 'src' is not NULL, the source address the
-    /// packet was sent to is filled in.
+    /// packet was sent to is filled in. Any number of tasks can wait on the
+    /// socket at once, each packet goes to the task waiting the longest.
     RetType recv(uint8_t* buff, size_t* len, addr_t* src) {
         RESUME();
 
-        // find a packet that's been received
-        packet_t** packet_p = m_rx.peek();
-
-        if(packet_p == NULL) {
-            // no packets buffered, need to block
-
-            if(m_blocked != -1) {
-                // another task is already blocking
-                return RET_ERROR;
-            }
-
-            // block until a packet arrives
-            // 'receive' will wake this task
-            m_blocked = sched_dispatched;
-            BLOCK();
-
-            // grab the packet that should have just arrived
-            // NOTE: assuming this is non-NULL as this task has been woken!
-            packet_p = m_rx.peek();
+        // block until a packet arrives, 'receive' wakes a waiting task
+        // when one does
+        // NOTE: another task waiting on this socket may have taken the packet
+        //       by the time we run, so check again every time we're woken
+        while(NULL == m_rx.peek()) {
+            CALL(m_waiters.wait());
         }
 
+        packet_t** packet_p = m_rx.peek();
         packet_t* packet = *packet_p;
 
-        // return the packet to the pool and take it's pointer off the queue
+        // take it's pointer off the queue
         m_rx.pop();
 
-        // NOTE: this should never fail
-        if(!m_pool.free(packet)) {
-            RESET();
-            return RET_ERROR;
-        }
+        // copy everything out before the packet goes back to the pool, the
+        // pool reuses freed storage for it's free list
 
         // find the number of bytes to actuall copy to 'buff'
         size_t min = packet->len;
@@ -201,6 +188,13 @@ public:
             memcpy(src->ip, packet->ip, 4);
         }
 
+        // return the packet to the pool
+        // NOTE: this should never fail
+        if(!m_pool.free(packet)) {
+            RESET();
+            return RET_ERROR;
+        }
+
         RESET();
         return RET_SUCCESS;
     }
@@ -237,9 +231,10 @@ public:
 
         // if no buffers are available, drop the oldest buffer
         if(buff == NULL) {
-            packet_t** oldest = m_rx.peek();
+            // copy the pointer before popping, the queue frees it's node
+            packet_t* oldest = *(m_rx.peek());
             m_rx.pop();
-            m_pool.free(*oldest);
+            m_pool.free(oldest);
 
             buff = m_pool.alloc();
             // NOTE: assuming buff is non-NULL here
@@ -262,10 +257,8 @@ public:
         buff->ip[2] = info.src.ipv4_addr << 8;
         buff->ip[3] = info.src.ipv4_addr;
 
-        // unblock the task waiting for a packet if there is one
-        if(m_blocked != -1) {
-            WAKE(m_blocked);
-        }
+        // unblock the task that's been waiting longest for a packet
+        m_waiters.wake_one();
 
         return RET_SUCCESS;
     }
@@ -295,7 +288,7 @@ protected:
                                                     m_pool(packet_pool),
                                                     m_udp(NULL),
                                                     m_addr({0, 0}),
-                                                    m_blocked(-1) {};
+                                                    m_waiters() {};
 
 private:
     // received packets queue
@@ -310,8 +303,8 @@ private:
     // the bound address
     addr_t m_addr;
 
-    // any blocked task
-    tid_t m_blocked;
+    // tasks blocked waiting for a packet
+    WaitQueue m_waiters;
 };
 
 
@@ -327,7 +320,7 @@ public:
 
 private:
     // allocated packet buffer
-    alloc::Queue<::IPv4UDPSocket::packet_t*, SIZE> m_buff;
+    alloc::RingQueue<::IPv4UDPSocket::packet_t*, SIZE> m_buff;
 
     // allocated packet pool
     alloc::Pool<::IPv4UDPSocket::packet_t, SIZE> m_pool;
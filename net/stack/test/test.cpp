@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "net/stack/IPv4UDP/IPv4UDPStack.h"
 #include "net/stack/IPv4UDP/IPv4UDPSocket.h"
@@ -97,6 +98,11 @@ int main() {
     printf("received: '%c %c %c %c %c' on port %u\n", buff[0], buff[1], buff[2], \
                                                       buff[3], buff[4], addr.port);
 
+    if(5 != len || 0 != memcmp(msg, buff, 5) || 8000 != addr.port) {
+        printf("received the wrong message\n");
+        exit(1);
+    }
+
     addr.ip[0] = 10;
     addr.ip[1] = 10;
     addr.ip[2] = 10;
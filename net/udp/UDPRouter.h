@@ -25,6 +25,8 @@ namespace udp {
 
             uint16_t *port_num_loc = layer_bindings.add(layer);
             if (!port_num_loc) {
+                // don't leave the port bound to nothing
+                port_bindings.remove(port_num);
                 return RET_ERROR;
             }
 
@@ -131,8 +133,8 @@ namespace udp {
         }
 
     private:
-        alloc::Hashmap<uint16_t, NetworkLayer *, SIZE, SIZE> port_bindings;
-        alloc::Hashmap<NetworkLayer *, uint16_t, SIZE, SIZE> layer_bindings;
+        alloc::Hashmap<uint16_t, NetworkLayer *, SIZE> port_bindings;
+        alloc::Hashmap<NetworkLayer *, uint16_t, SIZE> layer_bindings;
         NetworkLayer *transmitLayer;
     };
 }
@@ -0,0 +1,193 @@
+/*******************************************************************************
+*
+*  Name: atomic_pool.h
+*
+*  Purpose: Fixed size memory pool that's safe to allocate from and free to
+*           from interrupts and from multiple threads at once, without locks.
+*
+*           The free list is a Treiber stack of object indices. The head holds
+*           an index and a tag that changes on every push and pop, so an index
+*           that was popped and pushed back between another thread's load and
+*           swap (ABA) makes the swap fail.
+*
+*           Where the target has an 8 byte compare-and-swap the head is 64 bits
+*           with a 32 bit tag, which doesn't wrap in practice. Otherwise (e.g.
+*           Cortex-M) it's 32 bits with a 16 bit tag, which wraps after 65536
+*           operations: a thread or interrupt stalled inside 'alloc' while
+*           exactly a multiple of 65536 allocs and frees happen can corrupt the
+*           free list. Indices read from the list are checked before they're
+*           used, so that shows up as the pool running out rather than as an
+*           out of bounds access. Define ATOMIC_POOL_HEAD32 to use the 32 bit
+*           head everywhere.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef ATOMIC_POOL_H
+#define ATOMIC_POOL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8) && !defined(ATOMIC_POOL_HEAD32)
+/// @brief free list head, 32 bit tag and the index in the low 32 bits
+typedef uint64_t atomic_pool_head_t;
+#else
+/// @brief free list head, 16 bit tag and 16 bit index
+typedef uint32_t atomic_pool_head_t;
+#endif
+
+/// @brief lock-free memory pool of preallocated objects
+/// @tparam T       the type of objects in the pool
+template <typename T>
+class AtomicPool {
+public:
+    /// @brief allocate an object from the pool
+    ///        the object is default initialized, types without a constructor
+    ///        (e.g. plain structs) are left uninitialized
+    /// @return the pointer to the object, or NULL on failure
+    T* alloc() {
+        atomic_pool_head_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+
+        while(1) {
+            uint16_t i = index(head);
+
+            if(i >= m_size) {
+                // no room (NIL), or a wrapped tag let a bad link onto the head
+                return NULL;
+            }
+
+            // may be stale if another thread takes 'i' first, then the swap
+            // fails because the tag changed
+            uint16_t next = __atomic_load_n(&(m_next[i]), __ATOMIC_RELAXED);
+
+            if(ALLOCATED == next) {
+                // definitely stale, don't rely on the tag to catch it
+                head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+                continue;
+            }
+
+            atomic_pool_head_t new_head = retag(head, next);
+
+            if(__atomic_compare_exchange_n(&m_head, &head, new_head, true,
+                                           __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(&(m_next[i]), ALLOCATED, __ATOMIC_RELAXED);
+                // default initialized like 'Pool', so plain objects aren't
+                // zeroed on every alloc (e.g. from an ISR)
+                return new(&(m_objs[i])) T;
+            }
+        }
+    }
+
+    /// @brief free an object back to the pool
+    ///        the object is destroyed
+    /// @return 'true' if the free was successful, 'false' if the object was
+    ///         not allocated from this pool or was already freed
+    bool free(T* obj) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(obj);
+        uintptr_t base = reinterpret_cast<uintptr_t>(m_objs);
+
+        if(addr < base || addr >= base + m_size * sizeof(T)) {
+            return false;
+        }
+
+        if(0 != (addr - base) % sizeof(T)) {
+            return false;
+        }
+
+        uint16_t i = (addr - base) / sizeof(T);
+
+        // only one free of an allocated object gets past this
+        uint16_t allocated = ALLOCATED;
+        if(!__atomic_compare_exchange_n(&(m_next[i]), &allocated, NIL, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return false;
+        }
+
+        obj->~T();
+
+        atomic_pool_head_t head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+
+        while(1) {
+            __atomic_store_n(&(m_next[i]), index(head), __ATOMIC_RELAXED);
+            atomic_pool_head_t new_head = retag(head, i);
+
+            // release so the next thread to take the object sees it destroyed
+            if(__atomic_compare_exchange_n(&m_head, &head, new_head, true,
+                                           __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+                return true;
+            }
+        }
+    }
+
+protected:
+    /// @brief protected constructor
+    ///        use the alloc::AtomicPool constructor directly
+    /// @param objs     storage for 'size' many objects, does not need to be
+    ///                 constructed
+    /// @param next     array of 'size' many free list links
+    /// @param size     the number of objects in the pool, less than 65535
+    AtomicPool(T* objs, uint16_t* next, const size_t size) : m_objs(objs),
+                                                              m_next(next),
+                                                              m_size(size),
+                                                              m_head(NIL) {
+        // construct the free list so the first object is allocated first
+        for(size_t i = size; i > 0; i--) {
+            m_next[i - 1] = index(m_head);
+            m_head = i - 1;
+        }
+    }
+
+private:
+    // the index and tag are each half the head
+    static const unsigned INDEX_BITS = sizeof(atomic_pool_head_t) * 4;
+
+    // helper function to get the index from a head
+    static inline uint16_t index(atomic_pool_head_t head) {
+        return static_cast<uint16_t>(head);
+    }
+
+    // helper function to make a new head pointing at 'i' with the next tag
+    static inline atomic_pool_head_t retag(atomic_pool_head_t head, uint16_t i) {
+        return (((head >> INDEX_BITS) + 1) << INDEX_BITS) | i;
+    }
+
+    // end of the free list
+    static const uint16_t NIL = 0xFFFF;
+
+    // link of an object that's allocated
+    static const uint16_t ALLOCATED = 0xFFFE;
+
+    T* m_objs;
+    uint16_t* m_next;
+    size_t m_size;
+
+    // tag in the high half, index in the low half
+    // aligned to its size so 32 bit targets can swap it as one word
+    alignas(sizeof(atomic_pool_head_t)) atomic_pool_head_t m_head;
+};
+
+namespace alloc {
+
+/// @brief lock-free memory pool of preallocated objects
+/// @tparam T       the type of objects in the pool
+/// @tparam SIZE    the number of objects in the pool
+template <typename T, const size_t SIZE>
+class AtomicPool : public ::AtomicPool<T> {
+public:
+    static_assert(SIZE > 0 && SIZE < 0xFFFE, "AtomicPool size must fit in a 16 bit index");
+
+    /// @brief constructor
+    AtomicPool() : ::AtomicPool<T>(reinterpret_cast<T*>(m_objs), m_next, SIZE) {};
+
+private:
+    alignas(T) uint8_t m_objs[SIZE * sizeof(T)];
+    uint16_t m_next[SIZE];
+};
+
+}
+
+#endif
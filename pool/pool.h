@@ -4,6 +4,15 @@
 *
 *  Purpose: Contains implementation for a fixed size memory pool.
 *
+*           The free list is threaded through the storage of the free objects
+*           themselves, so the only overhead is one bit per object to catch
+*           double frees. Objects are constructed when they're allocated and
+*           destroyed when they're freed.
+*
+*           Define POOL_POISON to fill freed objects with a pattern that's
+*           checked when they're allocated again, catching writes through
+*           pointers that were already freed.
+*
 *  Author: Will Merges
 *
 *  RIT Launch Initiative
@@ -14,16 +23,24 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <new>
 
-#include "queue/queue.h"
-#include "macros.h"
+/// @brief byte freed objects are filled with when POOL_POISON is defined
+#ifndef POOL_POISON_BYTE
+#define POOL_POISON_BYTE 0xA5
+#endif
 
-/// @brief descriptor for an object
-/// @tparam T   type of object described
+/// @brief storage for one object, holds the free list link while it's free
+/// @tparam T   type of object stored
 template <typename T>
-struct PoolDescriptor {
-    void* owner;
-    bool allocated;
+union PoolSlot {
+    // does nothing, the pool links the slots before the derived class's
+    // storage is constructed
+    PoolSlot() {};
+    ~PoolSlot() {};
+
+    PoolSlot* next;
     T obj;
 };
 
@@ -33,76 +50,145 @@ template <typename T>
 class Pool {
 public:
     /// @brief allocate an object from the pool
+    ///        the object is default initialized, types without a constructor
+    ///        (e.g. plain structs) are left uninitialized
     /// @return the pointer to the object, or NULL on failure
     T* alloc() {
-        Node<PoolDescriptor<T>*>* node = m_freeDesc.pop_node();
+        PoolSlot<T>* slot = m_free;
+
+        while(slot != NULL) {
+            m_free = slot->next;
+
+#ifdef POOL_POISON
+            if(!poisoned(slot)) {
+                // written to after it was freed, leave it out of the pool
+                m_corrupted++;
+                slot = m_free;
+                continue;
+            }
+#endif
 
-        if(node == NULL) {
-            // no room
-            return NULL;
-        }
+            size_t i = slot - m_slots;
+            m_used[i / 32] |= (1U << (i % 32));
 
-        // this node is unused now
-        m_freeNodes.push_node(node);
+            // default initialized, so large plain objects (e.g. packet buffers)
+            // aren't zeroed on every alloc
+            return new(&(slot->obj)) T;
+        }
 
-        node->data->allocated = true;
-        return &(node->data->obj);
+        // no room
+        return NULL;
     }
 
     /// @brief free an object back to the pool
-    /// NOTE: some double frees are caught, but it's possible a double free
-    ///       could result in an object being on the free list twice
-    /// @return 'true' if the free was successful, 'false' on error
+    ///        the object is destroyed
+    /// @return 'true' if the free was successful, 'false' if the object was
+    ///         not allocated from this pool or was already freed
     virtual bool free(T* obj) {
-        // check this object is both allocated and from this pool
-        PoolDescriptor<T>* desc = container_of(obj, PoolDescriptor<T>, obj);
+        // check the object is from this pool
+        uintptr_t addr = reinterpret_cast<uintptr_t>(obj);
+        uintptr_t base = reinterpret_cast<uintptr_t>(m_slots);
 
-        if(!desc->allocated) {
+        if(addr < base || addr >= base + m_size * sizeof(PoolSlot<T>)) {
             return false;
         }
 
-        if(desc->owner != this) {
+        if(0 != (addr - base) % sizeof(PoolSlot<T>)) {
             return false;
         }
 
-        Node<PoolDescriptor<T>*>* node = m_freeNodes.pop_node();
+        size_t i = (addr - base) / sizeof(PoolSlot<T>);
+        uint32_t bit = 1U << (i % 32);
 
-        if(node == NULL) {
+        // check the object is allocated
+        if(!(m_used[i / 32] & bit)) {
             return false;
         }
 
-        // offer this descriptor as free now
-        desc->allocated = false;
-        node->data = desc;
-        m_freeDesc.push_node(node);
+        m_used[i / 32] &= ~bit;
+        obj->~T();
+
+        PoolSlot<T>* slot = &(m_slots[i]);
+
+#ifdef POOL_POISON
+        memset(static_cast<void*>(slot), POOL_POISON_BYTE, sizeof(PoolSlot<T>));
+#endif
+
+        slot->next = m_free;
+        m_free = slot;
 
         return true;
     }
+
+#ifdef POOL_POISON
+    /// @brief get the number of objects found written to after being freed
+    ///        these are left out of the pool
+    size_t corrupted() {
+        return m_corrupted;
+    }
+#endif
+
 protected:
     /// @brief protected constructor
     ///        use the alloc::Pool constructor directly
-    /// @param desc     array of 'size' many preallocated descriptors
-    /// @param nodes    array of 'size' many preallocated nodes
+    /// @param slots    array of 'size' many preallocated slots
+    /// @param used     array of at least 'size' many bits, marks allocated slots
     /// @param size     the number of objects in the pool
-    Pool(PoolDescriptor<T>* desc, Node<PoolDescriptor<T>*>* nodes, const size_t size) :
-                                                        m_desc(desc),
-                                                        m_nodes(nodes),
-                                                        m_freeDesc(),
-                                                        m_freeNodes() {
-        // construct the free object list
-        for(size_t i = 0; i < size; i++) {
-            m_desc[i].owner = this;
-            m_desc[i].allocated = false;
-            m_nodes[i].data = &(m_desc[i]);
-            m_freeDesc.push_node(&m_nodes[i]);
+    Pool(PoolSlot<T>* slots, uint32_t* used, const size_t size) :
+                                                        m_slots(slots),
+                                                        m_used(used),
+                                                        m_size(size),
+                                                        m_free(NULL) {
+#ifdef POOL_POISON
+        m_corrupted = 0;
+#endif
+
+        memset(m_used, 0, ((size + 31) / 32) * sizeof(uint32_t));
+
+        // construct the free list so the first slot is allocated first
+        for(size_t i = size; i > 0; i--) {
+            PoolSlot<T>* slot = &(m_slots[i - 1]);
+
+#ifdef POOL_POISON
+            memset(static_cast<void*>(slot), POOL_POISON_BYTE, sizeof(PoolSlot<T>));
+#endif
+
+            slot->next = m_free;
+            m_free = slot;
+        }
+    }
+
+    /// @brief destructor, destroys any objects still allocated
+    virtual ~Pool() {
+        for(size_t i = 0; i < m_size; i++) {
+            if(m_used[i / 32] & (1U << (i % 32))) {
+                m_slots[i].obj.~T();
+            }
         }
     }
 
 private:
-    PoolDescriptor<T>* m_desc;
-    Node<PoolDescriptor<T>*>* m_nodes;
-    SimpleQueue<PoolDescriptor<T>*> m_freeDesc;  // holds free descriptors, unallocated
-    SimpleQueue<PoolDescriptor<T>*> m_freeNodes; // holds free nodes that have their descriptors allocated
+#ifdef POOL_POISON
+    // helper function to check a free slot is still poisoned past it's link
+    static bool poisoned(PoolSlot<T>* slot) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(slot);
+
+        for(size_t i = sizeof(PoolSlot<T>*); i < sizeof(PoolSlot<T>); i++) {
+            if(POOL_POISON_BYTE != bytes[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t m_corrupted;
+#endif
+
+    PoolSlot<T>* m_slots;
+    uint32_t* m_used;
+    size_t m_size;
+    PoolSlot<T>* m_free; // top of the free list
 };
 
 namespace alloc {
@@ -114,11 +200,11 @@ template <typename T, const size_t SIZE>
 class Pool : public ::Pool<T> {
 public:
     /// @brief constructor
-    Pool() : ::Pool<T>(m_internalDesc, m_internalNodes, SIZE) {};
+    Pool() : ::Pool<T>(m_slots, m_used, SIZE) {};
 
 private:
-    PoolDescriptor<T> m_internalDesc[SIZE];
-    Node<PoolDescriptor<T>*> m_internalNodes[SIZE];
+    PoolSlot<T> m_slots[SIZE];
+    uint32_t m_used[(SIZE + 31) / 32];
 };
 
 }
@@ -0,0 +1,109 @@
+// benchmarks alloc/free throughput of the lock-free pool against the regular
+// pool, on one thread and on several threads where the regular pool needs a
+// lock around it
+//
+// build: g++ -O2 -pthread -I../.. atomic_bench.cpp -o atomic_bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "pool/pool.h"
+#include "pool/atomic_pool.h"
+
+static const int NUM_OPS = 4000000;
+static const int MAX_THREADS = 4;
+static const size_t POOL_SIZE = 64;
+
+typedef struct {
+    uint8_t data[64];
+} buff_t;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static alloc::Pool<buff_t, POOL_SIZE> pool;
+static alloc::AtomicPool<buff_t, POOL_SIZE> atomic_pool;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int num_threads;
+
+void* pool_thread(void*) {
+    int ops = NUM_OPS / num_threads;
+
+    for(int i = 0; i < ops; i++) {
+        pthread_mutex_lock(&pool_lock);
+        buff_t* b = pool.alloc();
+        pthread_mutex_unlock(&pool_lock);
+
+        b->data[0] = i;
+
+        pthread_mutex_lock(&pool_lock);
+        pool.free(b);
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    return NULL;
+}
+
+void* atomic_thread(void*) {
+    int ops = NUM_OPS / num_threads;
+
+    for(int i = 0; i < ops; i++) {
+        buff_t* b = atomic_pool.alloc();
+        b->data[0] = i;
+        atomic_pool.free(b);
+    }
+
+    return NULL;
+}
+
+// returns ns per alloc/free pair
+double run(void* (*func)(void*), int threads) {
+    pthread_t t[MAX_THREADS];
+    num_threads = threads;
+
+    uint64_t start = now_ns();
+    for(int i = 0; i < threads; i++) {
+        pthread_create(&(t[i]), NULL, func, NULL);
+    }
+
+    for(int i = 0; i < threads; i++) {
+        pthread_join(t[i], NULL);
+    }
+
+    return (double)(now_ns() - start) / NUM_OPS;
+}
+
+int main() {
+    // single threaded, no lock needed for the regular pool
+    uint64_t start = now_ns();
+    for(int i = 0; i < NUM_OPS; i++) {
+        buff_t* b = pool.alloc();
+        b->data[0] = i;
+        pool.free(b);
+    }
+    double pool_ns = (double)(now_ns() - start) / NUM_OPS;
+
+    start = now_ns();
+    for(int i = 0; i < NUM_OPS; i++) {
+        buff_t* b = atomic_pool.alloc();
+        b->data[0] = i;
+        atomic_pool.free(b);
+    }
+    double atomic_ns = (double)(now_ns() - start) / NUM_OPS;
+
+    printf("1 thread:  Pool %.1f ns, AtomicPool %.1f ns per alloc/free\n", pool_ns, atomic_ns);
+
+    for(int threads = 2; threads <= MAX_THREADS; threads *= 2) {
+        pool_ns = run(&pool_thread, threads);
+        atomic_ns = run(&atomic_thread, threads);
+
+        printf("%i threads: Pool + mutex %.1f ns, AtomicPool %.1f ns per alloc/free\n",
+               threads, pool_ns, atomic_ns);
+    }
+}
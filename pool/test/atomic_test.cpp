@@ -0,0 +1,146 @@
+// tests the lock-free pool, including several threads allocating and freeing
+// from the same pool at once
+//
+// build: g++ -O2 -pthread -I../.. atomic_test.cpp -o atomic_test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "pool/atomic_pool.h"
+
+bool basic() {
+    alloc::AtomicPool<int, 5> pool;
+
+    int* ptrs[5];
+    for(size_t i = 0; i < 5; i++) {
+        ptrs[i] = pool.alloc();
+        if(ptrs[i] == NULL) {
+            printf("got NULL on pointer %li\n", i);
+            return false;
+        }
+    }
+
+    if(pool.alloc()) {
+        printf("pool did not deny allocating over size limit\n");
+        return false;
+    }
+
+    for(size_t i = 0; i < 5; i++) {
+        if(!pool.free(ptrs[i])) {
+            printf("failed to free pointer %lu\n", i);
+            return false;
+        }
+    }
+
+    // try and double free
+    if(pool.free(ptrs[0])) {
+        printf("allowed double free\n");
+        return false;
+    }
+
+    int x;
+    if(pool.free(&x)) {
+        printf("allowed freeing object not from the pool\n");
+        return false;
+    }
+
+    for(size_t i = 0; i < 5; i++) {
+        ptrs[i] = pool.alloc();
+        if(ptrs[i] == NULL) {
+            printf("got NULL on pointer %li\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const int NUM_THREADS = 4;
+static const int NUM_ROUNDS = 200000;
+static const size_t POOL_SIZE = 16;
+static const int HOLD = 3;
+
+typedef struct {
+    uint32_t owner;
+    uint32_t round;
+} item_t;
+
+static alloc::AtomicPool<item_t, POOL_SIZE> stress_pool;
+static int errors[NUM_THREADS];
+
+// allocates a few objects, checks nobody else was handed them, frees them
+void* stress(void* arg) {
+    uint32_t me = (uint32_t)(size_t)arg;
+    item_t* held[HOLD];
+
+    for(int r = 0; r < NUM_ROUNDS; r++) {
+        for(int i = 0; i < HOLD; i++) {
+            // 4 threads holding 3 each never empty a pool of 16
+            held[i] = stress_pool.alloc();
+            if(NULL == held[i]) {
+                errors[me]++;
+                return NULL;
+            }
+
+            held[i]->owner = me;
+            held[i]->round = r;
+        }
+
+        for(int i = 0; i < HOLD; i++) {
+            if(held[i]->owner != me || held[i]->round != (uint32_t)r) {
+                // someone else has our object
+                errors[me]++;
+            }
+
+            if(!stress_pool.free(held[i])) {
+                errors[me]++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+bool stress_test() {
+    pthread_t threads[NUM_THREADS];
+
+    for(int i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&(threads[i]), NULL, &stress, (void*)(size_t)i);
+    }
+
+    for(int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for(int i = 0; i < NUM_THREADS; i++) {
+        if(errors[i]) {
+            printf("thread %i had %i errors\n", i, errors[i]);
+            return false;
+        }
+    }
+
+    // every object made it back
+    for(size_t i = 0; i < POOL_SIZE; i++) {
+        if(NULL == stress_pool.alloc()) {
+            printf("only %lu objects left in the pool\n", i);
+            return false;
+        }
+    }
+
+    return NULL == stress_pool.alloc();
+}
+
+int main() {
+    if(basic()) {
+        printf("passed basic test\n");
+    } else {
+        printf("failed basic test\n");
+    }
+
+    if(stress_test()) {
+        printf("passed stress test\n");
+    } else {
+        printf("failed stress test\n");
+    }
+}
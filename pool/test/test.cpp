@@ -1,3 +1,6 @@
+// build: g++ -I../.. test.cpp -o test
+//        add -DPOOL_POISON to test poisoning
+
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -35,6 +38,8 @@ bool basic() {
             return false;
         }
     }
+
+    return true;
 }
 
 bool double_free() {
@@ -83,6 +88,114 @@ bool double_free() {
     return true;
 }
 
+// objects are constructed on alloc and destroyed on free
+static int live = 0;
+
+struct Counted {
+    Counted() : value(7) {
+        live++;
+    }
+
+    ~Counted() {
+        live--;
+    }
+
+    int value;
+};
+
+bool construct() {
+    {
+        alloc::Pool<Counted, 3> pool;
+
+        Counted* a = pool.alloc();
+        Counted* b = pool.alloc();
+
+        if(a == NULL || b == NULL || live != 2) {
+            printf("expected 2 live objects, have %i\n", live);
+            return false;
+        }
+
+        a->value = 1;
+        pool.free(a);
+
+        if(live != 1) {
+            printf("free did not destroy object\n");
+            return false;
+        }
+
+        a = pool.alloc();
+        if(a == NULL || a->value != 7) {
+            printf("alloc did not construct object\n");
+            return false;
+        }
+    }
+
+    // pool going away destroys what's left
+    if(live != 0) {
+        printf("%i objects left after pool destroyed\n", live);
+        return false;
+    }
+
+    return true;
+}
+
+bool foreign() {
+    alloc::Pool<int, 5> pool;
+    alloc::Pool<int, 5> other;
+
+    int* ptr = pool.alloc();
+    int x;
+
+    if(other.free(ptr)) {
+        printf("allowed freeing object from another pool\n");
+        return false;
+    }
+
+    if(pool.free(&x)) {
+        printf("allowed freeing object not from a pool\n");
+        return false;
+    }
+
+    if(pool.free(reinterpret_cast<int*>(reinterpret_cast<char*>(ptr) + 1))) {
+        printf("allowed freeing pointer into the middle of an object\n");
+        return false;
+    }
+
+    return pool.free(ptr);
+}
+
+#ifdef POOL_POISON
+bool poison() {
+    struct Big {
+        uint64_t words[4];
+    };
+
+    alloc::Pool<Big, 2> pool;
+
+    Big* a = pool.alloc();
+    Big* b = pool.alloc();
+
+    pool.free(a);
+    pool.free(b);
+
+    // use after free
+    b->words[2] = 0;
+
+    // the corrupted object is skipped
+    if(pool.alloc() != a || pool.alloc() != NULL) {
+        printf("handed out corrupted object\n");
+        return false;
+    }
+
+    if(pool.corrupted() != 1) {
+        printf("expected 1 corrupted object, got %lu\n", pool.corrupted());
+        return false;
+    }
+
+    return true;
+}
+#endif
+
 int main() {
     if(basic()) {
         printf("passed basic test\n");
@@ -95,4 +208,24 @@ int main() {
     } else {
         printf("failed double free test\n");
     }
+
+    if(construct()) {
+        printf("passed construct test\n");
+    } else {
+        printf("failed construct test\n");
+    }
+
+    if(foreign()) {
+        printf("passed foreign test\n");
+    } else {
+        printf("failed foreign test\n");
+    }
+
+#ifdef POOL_POISON
+    if(poison()) {
+        printf("passed poison test\n");
+    } else {
+        printf("failed poison test\n");
+    }
+#endif
 }
@@ -0,0 +1,233 @@
+/*******************************************************************************
+*
+*  Name: priority_queue.h
+*
+*  Purpose: Contains implementation for a preallocated priority queue.
+*           Objects stay in a fixed slot for as long as they're in the queue,
+*           so the pointer returned by 'push' can be used to remove or update
+*           the object later. The heap itself only holds slot indices.
+*           Push, pop, remove, and update are O(log n).
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/// @brief default priority queue comparator, smallest object first
+template <typename T>
+struct PriorityLess {
+    /// @brief returns true if 'fst' should be popped before 'snd'
+    bool operator()(const T& fst, const T& snd) const {
+        return fst < snd;
+    }
+};
+
+namespace alloc {
+
+/// @brief preallocated priority queue, an indexed binary heap
+/// @tparam T       the object type stored in the queue
+/// @tparam SIZE    the most objects in the queue
+/// @tparam Compare functor type, 'Compare()(a, b)' returns true if 'a' should
+///                 be popped before 'b'
+template <typename T, const size_t SIZE, typename Compare = PriorityLess<T>>
+class PriorityQueue {
+public:
+    static_assert(SIZE > 0 && SIZE < 0xFFFF, "PriorityQueue size must fit in a 16 bit index");
+
+    /// @brief constructor
+    PriorityQueue() : m_len(0), m_free_len(SIZE) {
+        // hand out the first slot first
+        for(size_t i = 0; i < SIZE; i++) {
+            m_free[i] = SIZE - 1 - i;
+            m_pos[i] = FREE;
+        }
+    };
+
+    /// @brief push an object onto the queue, copying it in the process
+    /// @return the pointer to the pushed object, or NULL if the queue is full
+    ///         stays valid until the object is popped or removed
+    T* push(const T& obj) {
+        // the free list empties when the heap fills, checking both lets the
+        // compiler see 'm_heap' can't overflow
+        if(0 == m_free_len || m_len >= SIZE) {
+            return NULL;
+        }
+
+        uint16_t slot = m_free[--m_free_len];
+        m_objs[slot] = obj;
+
+        m_heap[m_len] = slot;
+        m_pos[slot] = m_len;
+        m_len++;
+
+        sift_up(m_len - 1);
+
+        return &(m_objs[slot]);
+    }
+
+    /// @brief pop the first object off the queue, if there is one to pop
+    /// @return
+    void pop() {
+        if(0 == m_len) {
+            return;
+        }
+
+        remove_at(0);
+    }
+
+    /// @brief peek at the first object in the queue
+    /// @return a pointer to the object, or NULL if the queue is empty
+    T* peek() {
+        if(0 == m_len) {
+            return NULL;
+        }
+
+        return &(m_objs[m_heap[0]]);
+    }
+
+    /// @brief remove an object from the queue
+    /// @param obj  the pointer returned by 'push'
+    /// @return 'true' on success, 'false' if 'obj' is not in the queue
+    bool remove(T* obj) {
+        uint16_t pos;
+
+        if(!position(obj, &pos)) {
+            return false;
+        }
+
+        remove_at(pos);
+        return true;
+    }
+
+    /// @brief move an object to it's new place after it was changed
+    /// @param obj  the pointer returned by 'push'
+    /// @return 'true' on success, 'false' if 'obj' is not in the queue
+    bool update(T* obj) {
+        uint16_t pos;
+
+        if(!position(obj, &pos)) {
+            return false;
+        }
+
+        fix(pos);
+        return true;
+    }
+
+    /// @brief get the number of objects in the queue
+    /// @return the size of the queue
+    size_t size() {
+        return m_len;
+    }
+
+private:
+    // position in the heap of slots that are free
+    static const uint16_t FREE = 0xFFFF;
+
+    // helper function to find the heap position of an object
+    bool position(T* obj, uint16_t* pos) {
+        size_t slot = obj - m_objs;
+
+        if(slot >= SIZE || FREE == m_pos[slot] || m_pos[slot] >= m_len) {
+            return false;
+        }
+
+        *pos = m_pos[slot];
+        return true;
+    }
+
+    // helper function to check if the object at heap position 'a' goes
+    // before the one at 'b'
+    bool before(uint16_t a, uint16_t b) {
+        return Compare()(m_objs[m_heap[a]], m_objs[m_heap[b]]);
+    }
+
+    // helper function to swap two heap positions
+    void swap(uint16_t a, uint16_t b) {
+        uint16_t tmp = m_heap[a];
+        m_heap[a] = m_heap[b];
+        m_heap[b] = tmp;
+
+        m_pos[m_heap[a]] = a;
+        m_pos[m_heap[b]] = b;
+    }
+
+    void sift_up(uint16_t i) {
+        while(i > 0) {
+            uint16_t parent = (i - 1) / 2;
+
+            if(!before(i, parent)) {
+                break;
+            }
+
+            swap(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(uint16_t i) {
+        while(1) {
+            uint16_t first = i;
+            uint16_t left = 2 * i + 1;
+            uint16_t right = left + 1;
+
+            if(left < m_len && before(left, first)) {
+                first = left;
+            }
+
+            if(right < m_len && before(right, first)) {
+                first = right;
+            }
+
+            if(first == i) {
+                break;
+            }
+
+            swap(i, first);
+            i = first;
+        }
+    }
+
+    // helper function to restore the heap around position 'i'
+    void fix(uint16_t i) {
+        if(i > 0 && before(i, (i - 1) / 2)) {
+            sift_up(i);
+        } else {
+            sift_down(i);
+        }
+    }
+
+    // helper function to take the object at heap position 'i' out
+    void remove_at(uint16_t i) {
+        uint16_t slot = m_heap[i];
+
+        m_len--;
+        if(i != m_len) {
+            // fill the hole with the last object
+            m_heap[i] = m_heap[m_len];
+            m_pos[m_heap[i]] = i;
+            fix(i);
+        }
+
+        m_pos[slot] = FREE;
+        m_free[m_free_len++] = slot;
+    }
+
+    T m_objs[SIZE];
+
+    uint16_t m_heap[SIZE];  // slot index at each heap position
+    uint16_t m_pos[SIZE];   // heap position of each slot
+    uint16_t m_len;
+
+    uint16_t m_free[SIZE];  // stack of free slots
+    uint16_t m_free_len;
+};
+
+}
+
+#endif
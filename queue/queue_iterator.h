@@ -12,6 +12,8 @@
 #ifndef QUEUE_ITERATOR_H
 #define QUEUE_ITERATOR_H
 
+#include <stddef.h>
+
 #include "queue/queue_node.h"
 
 /// @brief queue iterator
@@ -22,11 +24,32 @@ class QueueIterator {
 public:
     /// @brief constructor
     /// @param start    pointer to the starting node
-    QueueIterator(Node<T>* start) : m_curr(start) {};
+    QueueIterator(Node<T>* start) : m_curr(start), m_buff(NULL),
+                                    m_mask(0), m_idx(0), m_left(0) {};
+
+    /// @brief constructor for array-backed ring queues
+    /// @param buff     the ring's storage, a power of two in size
+    /// @param mask     size of 'buff' minus one
+    /// @param start    index of the starting element, not masked
+    /// @param count    number of elements from 'start' to the tail
+    QueueIterator(T* buff, size_t mask, size_t start, size_t count) :
+                                    m_curr(NULL), m_buff(buff), m_mask(mask),
+                                    m_idx(start), m_left(count) {};
 
     /// @brief iterate
     /// @return the next element in the queue, or NULL if read past the tail
     T* operator++() {
+        if(m_buff) {
+            if(m_left <= 1) {
+                m_left = 0;
+                return NULL;
+            }
+
+            m_idx++;
+            m_left--;
+            return &(m_buff[m_idx & m_mask]);
+        }
+
         if(!m_curr) {
             return NULL;
         }
@@ -43,6 +66,10 @@ public:
 
     /// @brief get the current value
     T* operator*() {
+        if(m_buff) {
+            return m_left ? &(m_buff[m_idx & m_mask]) : NULL;
+        }
+
         if(!m_curr) {
             return NULL;
         }
@@ -53,6 +80,12 @@ public:
 private:
     // current node
     Node<T>* m_curr;
+
+    // ring queues
+    T* m_buff;
+    size_t m_mask;
+    size_t m_idx;
+    size_t m_left;  // elements left including the current one
 };
 
 #endif
@@ -0,0 +1,143 @@
+/*******************************************************************************
+*
+*  Name: ring_queue.h
+*
+*  Purpose: Contains implementation for a preallocated queue stored in one
+*           contiguous ring, rather than linked nodes from a pool.
+*           Pushing and popping is just an index update, and there's no per
+*           entry overhead.
+*
+*           Entries keep their address from 'push' until they're popped,
+*           unless an entry in front of them is removed with 'remove', which
+*           moves the entries behind it up. Use 'alloc::Queue' if pointers to
+*           entries must stay valid across 'remove'.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "queue/queue.h"
+
+namespace alloc {
+
+/// @brief preallocated queue stored in a ring
+/// @tparam T       the object type stored in the queue
+/// @tparam SIZE    the most entries in the queue, storage is rounded up to a
+///                 power of two so indices can be masked rather than divided
+template <typename T, const size_t SIZE>
+class RingQueue : public ::Queue<T> {
+public:
+    static_assert(SIZE > 0, "RingQueue needs room for at least one entry");
+
+    /// @brief constructor
+    RingQueue() : m_head(0), m_tail(0) {};
+
+    /// @brief push an object onto the queue
+    /// @return the pointer to the pushed object, or NULL if the queue is full
+    T* push(T obj) {
+        T* slot = push();
+
+        if(slot == NULL) {
+            return NULL;
+        }
+
+        *slot = obj;
+        return slot;
+    }
+
+    /// @brief create an object at the end of the queue and get a pointer to it
+    /// @return the object, or NULL if the queue is full
+    T* push() {
+        if(m_tail - m_head >= SIZE) {
+            return NULL;
+        }
+
+        T* slot = &(m_buff[m_tail & MASK]);
+        m_tail++;
+
+        return slot;
+    }
+
+    /// @brief pop an object off the queue, if there is one to pop
+    /// @return
+    void pop() {
+        if(m_head != m_tail) {
+            m_head++;
+        }
+    }
+
+    /// @brief peek at the object on the back of the queue
+    /// @return a pointer to the object, or NULL on error
+    T* peek() {
+        if(m_head == m_tail) {
+            return NULL;
+        }
+
+        return &(m_buff[m_head & MASK]);
+    }
+
+    /// @brief remove an entry from the queue
+    ///        entries behind it are moved up, so pointers to them change
+    /// @param obj  a pointer to the object to remove
+    void remove(T* obj) {
+        size_t i = obj - m_buff;
+
+        if(i >= CAPACITY) {
+            // not ours
+            return;
+        }
+
+        // position from the head
+        size_t pos = (i - m_head) & MASK;
+        size_t len = m_tail - m_head;
+
+        if(pos >= len) {
+            // not in the queue
+            return;
+        }
+
+        for(size_t j = m_head + pos; j + 1 != m_tail; j++) {
+            m_buff[j & MASK] = m_buff[(j + 1) & MASK];
+        }
+
+        m_tail--;
+    }
+
+    /// @brief get the number of nodes on the queue
+    /// @return the size of the queue
+    size_t size() {
+        return m_tail - m_head;
+    }
+
+    /// @brief get an iterator starting at the head
+    /// @return the iterator
+    QueueIterator<T> iterator() {
+        return QueueIterator<T>{m_buff, MASK, m_head, m_tail - m_head};
+    }
+
+private:
+    // smallest power of two that holds 'n' entries
+    static constexpr size_t ring_size(size_t n) {
+        return (n <= 1) ? 1 : 2 * ring_size((n + 1) / 2);
+    }
+
+    static constexpr size_t CAPACITY = ring_size(SIZE);
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    T m_buff[CAPACITY];
+
+    // free running, masked to index, so 'm_tail - m_head' is always the size
+    size_t m_head;
+    size_t m_tail;
+};
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+// benchmarks the ring queue against the linked queue, pushing and popping the
+// small payloads queues mostly hold (task IDs and pointers)
+//
+// build: g++ -O2 -I../.. ring_bench.cpp -o ring_bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "queue/allocated_queue.h"
+#include "queue/ring_queue.h"
+
+static const int NUM_OPS = 10000000;
+static const size_t QUEUE_SIZE = 64;
+static const int BATCH = 16;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static volatile int sink;
+
+// push a batch then pop it, through the interface like callers do
+// returns ns per push/pop pair
+template <typename T>
+double run(Queue<T>& q) {
+    uint64_t start = now_ns();
+
+    for(int i = 0; i < NUM_OPS; i += BATCH) {
+        for(int j = 0; j < BATCH; j++) {
+            q.push((T)(size_t)(i + j));
+        }
+
+        for(int j = 0; j < BATCH; j++) {
+            sink = (int)(size_t)*(q.peek());
+            q.pop();
+        }
+    }
+
+    return (double)(now_ns() - start) / NUM_OPS;
+}
+
+template <typename T>
+void compare(const char* name) {
+    alloc::Queue<T, QUEUE_SIZE> linked;
+    alloc::RingQueue<T, QUEUE_SIZE> ring;
+
+    double linked_ns = run<T>(linked);
+    double ring_ns = run<T>(ring);
+
+    printf("%-8s linked %.2f ns, ring %.2f ns per push/pop, %lu vs %lu bytes\n",
+           name, linked_ns, ring_ns, sizeof(linked), sizeof(ring));
+}
+
+int main() {
+    compare<int>("int");
+    compare<void*>("void*");
+}
@@ -3,6 +3,8 @@
 
 #include "queue/queue.h"
 #include "queue/allocated_queue.h"
+#include "queue/ring_queue.h"
+#include "queue/priority_queue.h"
 
 bool basic() {
     SimpleQueue<int> q;
@@ -376,6 +378,218 @@ bool prealloc_remove() {
     return true;
 }
 
+bool ring_basic() {
+    // rounded up to 4 entries of storage, still only holds 3
+    alloc::RingQueue<int, 3> q;
+
+    // go around the ring a few times
+    for(int round = 0; round < 5; round++) {
+        for(int i = 0; i < 3; i++) {
+            if(q.push(round * 3 + i) == NULL) {
+                printf("failed to push %i\n", round * 3 + i);
+                return false;
+            }
+        }
+
+        if(q.push(-1) != NULL) {
+            printf("pushed onto full queue\n");
+            return false;
+        }
+
+        if(q.size() != 3) {
+            printf("bad size on queue, should be 3 but is %lu\n", q.size());
+            return false;
+        }
+
+        // iterate head to tail
+        QueueIterator<int> it = q.iterator();
+        int expect = round * 3;
+        for(int* obj = *it; obj != NULL; obj = ++it) {
+            if(*obj != expect) {
+                printf("bad iterator value, should be %i but is %i\n", expect, *obj);
+                return false;
+            }
+            expect++;
+        }
+
+        if(expect != round * 3 + 3) {
+            printf("iterator stopped early\n");
+            return false;
+        }
+
+        for(int i = 0; i < 3; i++) {
+            if(*(q.peek()) != round * 3 + i) {
+                printf("bad peek on %i\n", round * 3 + i);
+                return false;
+            }
+
+            q.pop();
+        }
+
+        if(q.size() != 0 || q.peek() != NULL) {
+            printf("queue not empty\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ring_remove() {
+    alloc::RingQueue<int, 4> q;
+
+    // start part way around the ring so the entries wrap
+    q.push(-1);
+    q.push(-1);
+    q.pop();
+    q.pop();
+
+    int* ptrs[4];
+    for(int i = 0; i < 4; i++) {
+        ptrs[i] = q.push(i);
+    }
+
+    // remove from the middle
+    q.remove(ptrs[1]);
+
+    if(q.size() != 3) {
+        printf("bad size on queue, should be 3 but is %lu\n", q.size());
+        return false;
+    }
+
+    // entries in front of the removed one didn't move
+    if(*(ptrs[0]) != 0) {
+        printf("entry in front of removed entry moved\n");
+        return false;
+    }
+
+    int expect[] = {0, 2, 3};
+    for(int i = 0; i < 3; i++) {
+        if(*(q.peek()) != expect[i]) {
+            printf("bad peek, should be %i but is %i\n", expect[i], *(q.peek()));
+            return false;
+        }
+
+        q.pop();
+    }
+
+    return q.size() == 0;
+}
+
+// biggest first
+struct IntGreater {
+    bool operator()(const int& fst, const int& snd) const {
+        return fst > snd;
+    }
+};
+
+bool priority() {
+    alloc::PriorityQueue<int, 64> q;
+    int counts[1000] = {0};
+
+    // push pseudo-random values, remove some by handle
+    uint32_t seed = 1;
+    for(int i = 0; i < 64; i++) {
+        seed = seed * 1664525U + 1013904223U;
+        int val = (seed >> 8) % 1000;
+
+        int* obj = q.push(val);
+        if(obj == NULL) {
+            printf("failed to push %i\n", i);
+            return false;
+        }
+
+        if(i % 4 == 0) {
+            if(!q.remove(obj)) {
+                printf("failed to remove %i\n", val);
+                return false;
+            }
+        } else {
+            counts[val]++;
+        }
+    }
+
+    // fill the slots that were freed by removing
+    while(q.size() < 64) {
+        if(q.push(500) == NULL) {
+            printf("failed to reuse slot\n");
+            return false;
+        }
+
+        counts[500]++;
+    }
+
+    if(q.push(0) != NULL) {
+        printf("pushed onto full queue\n");
+        return false;
+    }
+
+    // removing twice fails
+    int* top = q.peek();
+    int val = *top;
+    q.pop();
+    counts[val]--;
+
+    if(q.remove(top)) {
+        printf("removed object that was already popped\n");
+        return false;
+    }
+
+    // pops come out smallest first
+    int last = val;
+    while(q.size() > 0) {
+        val = *(q.peek());
+
+        if(val < last) {
+            printf("popped %i after %i\n", val, last);
+            return false;
+        }
+
+        counts[val]--;
+        last = val;
+        q.pop();
+    }
+
+    for(int i = 0; i < 1000; i++) {
+        if(counts[i] != 0) {
+            printf("value %i lost or popped twice\n", i);
+            return false;
+        }
+    }
+
+    return q.peek() == NULL;
+}
+
+bool priority_update() {
+    alloc::PriorityQueue<int, 4, IntGreater> q;
+
+    int* a = q.push(1);
+    q.push(2);
+    q.push(3);
+
+    if(*(q.peek()) != 3) {
+        printf("bad peek, should be 3 but is %i\n", *(q.peek()));
+        return false;
+    }
+
+    // move the smallest to the front
+    *a = 10;
+    q.update(a);
+
+    if(q.peek() != a) {
+        printf("updated object did not move to the front\n");
+        return false;
+    }
+
+    q.pop();
+    if(*(q.peek()) != 3) {
+        printf("bad peek, should be 3 but is %i\n", *(q.peek()));
+        return false;
+    }
+
+    return true;
+}
+
 int main() {
     if(!basic()) {
         printf("failed basic push/pop test\n");
@@ -406,4 +620,28 @@ int main() {
     } else {
         printf("passed preallocated remove test\n");
     }
+
+    if(!ring_basic()) {
+        printf("failed ring basic test\n");
+    } else {
+        printf("passed ring basic test\n");
+    }
+
+    if(!ring_remove()) {
+        printf("failed ring remove test\n");
+    } else {
+        printf("passed ring remove test\n");
+    }
+
+    if(!priority()) {
+        printf("failed priority test\n");
+    } else {
+        printf("passed priority test\n");
+    }
+
+    if(!priority_update()) {
+        printf("failed priority update test\n");
+    } else {
+        printf("passed priority update test\n");
+    }
 }
@@ -8,7 +8,8 @@ typedef enum {
     RET_ERROR,              // some error
     RET_BLOCKED,            // something blocked
     RET_SLEEP,              // something slept
-    RET_YIELD               // something yielded
+    RET_YIELD,              // something yielded
+    RET_TIMEOUT             // something timed out before it happened
 } RetType;
 
 // if RET_BLOCKED, RET_SLEEP, or RET_YIELD are ever returned, the task must return as fast
@@ -4,6 +4,13 @@
 *
 *  Purpose: Implements a fixed size circular queue / ring buffer.
 *
+*           Data in the buffer is at most two contiguous spans, the part before
+*           the end of the storage and the part that wrapped around to the
+*           start, so pushes and pops are at most two memcpys.
+*           The spans can be used directly to work on data in place:
+*               'peek_spans' and 'commit_read' to consume data
+*               'reserve_spans' and 'commit_write' to produce data
+*
 *  Author: Will Merges
 *
 *  RIT Launch Initiative
@@ -12,8 +19,18 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
 #include "return.h"
 
+/// @brief contiguous piece of a ring buffer
+typedef struct {
+    uint8_t* buff;
+    size_t len;
+} ringbuffer_span_t;
+
 /// @brief ring buffer
 class RingBuffer {
 public:
@@ -24,27 +41,38 @@ public:
     /// Will push at most 'len' bytes onto the buffer
     /// if overwrite is enabled, will guaranteed push 'len' bytes
     size_t push(uint8_t *buff, size_t len) {
+        size_t pushed = len;
+
         if (m_len + len > m_size) {
             if (m_overwrite) {
-                // move the head back to make room
-                m_head = (len + m_tail) % m_size;
+                if (len > m_size) {
+                    // only the newest data fits
+                    buff += len - m_size;
+                    len = m_size;
+                }
+
+                // drop the oldest data to make room
+                commit_read(m_len + len - m_size);
             } else {
                 // copy less data
                 len = m_size - m_len;
-                m_len += len;
+                pushed = len;
             }
-        } else {
-            m_len += len;
         }
 
-        size_t i = 0;
-        while (i < len) {
-            m_buff[m_tail] = buff[i];
-            i++;
-            m_tail = (m_tail + 1) % m_size;
+        // up to the end of the storage, then the rest from the start
+        size_t first = m_size - m_tail;
+        if (first > len) {
+            first = len;
+        }
+
+        copy(m_buff + m_tail, buff, first);
+        if (len > first) {
+            copy(m_buff, buff + first, len - first);
         }
 
-        return i;
+        commit_write(len);
+        return pushed;
     }
 
     /// @brief push data intto the buffer
@@ -67,18 +95,22 @@ public:
     /// Will pop at most 'len' bytes, but will pop less if there is less data
     /// in the buffer
     size_t pop(uint8_t *buff, size_t len) {
-        size_t i = 0;
-        while (i < len) {
-            buff[i] = m_buff[m_head];
-            i++;
-            m_head = (m_head + 1) % m_size;
-            if (m_head == m_tail) {
-                break;
-            }
+        if (len > m_len) {
+            len = m_len;
+        }
+
+        size_t first = m_size - m_head;
+        if (first > len) {
+            first = len;
+        }
+
+        copy(buff, m_buff + m_head, first);
+        if (len > first) {
+            copy(buff + first, m_buff, len - first);
         }
 
-        m_len -= i;
-        return i;
+        commit_read(len);
+        return len;
     }
 
     /// @brief pop data off the buffer
@@ -87,13 +119,77 @@ public:
     /// @return
     template<typename T>
     RetType pop(T *obj) {
-        if (sizeof(T) != pop(reinterpret_cast<uint8_t *>(obj), sizeof(T))) {
+        if (sizeof(T) > m_len) {
             return RET_ERROR;
         }
 
+        pop(reinterpret_cast<uint8_t *>(obj), sizeof(T));
         return RET_SUCCESS;
     }
 
+    /// @brief get the data in the buffer without copying it
+    /// @param spans    filled with the data oldest first, the second span is
+    ///                 empty unless the data wraps around the end
+    /// @return the total number of bytes in 'spans'
+    size_t peek_spans(ringbuffer_span_t spans[2]) {
+        size_t first = m_size - m_head;
+        if (first > m_len) {
+            first = m_len;
+        }
+
+        spans[0].buff = m_buff + m_head;
+        spans[0].len = first;
+        spans[1].buff = m_buff;
+        spans[1].len = m_len - first;
+
+        return m_len;
+    }
+
+    /// @brief remove data from the front of the buffer, after it was used
+    ///        through 'peek_spans'
+    /// @param len  the number of bytes to remove, at most 'size()'
+    void commit_read(size_t len) {
+        if (len > m_len) {
+            len = m_len;
+        }
+
+        m_head = wrap(m_head + len);
+        m_len -= len;
+    }
+
+    /// @brief get the free space in the buffer to write into directly
+    ///        the space is never over data in the buffer, even if overwrite
+    ///        is enabled
+    /// @param spans    filled with the free space in the order it's written
+    /// @return the total number of bytes in 'spans'
+    size_t reserve_spans(ringbuffer_span_t spans[2]) {
+        size_t free = m_size - m_len;
+
+        size_t first = m_size - m_tail;
+        if (first > free) {
+            first = free;
+        }
+
+        spans[0].buff = m_buff + m_tail;
+        spans[0].len = first;
+        spans[1].buff = m_buff;
+        spans[1].len = free - first;
+
+        return free;
+    }
+
+    /// @brief add data to the end of the buffer, after it was written through
+    ///        'reserve_spans'
+    /// @param len  the number of bytes written, at most 'capacity() - size()'
+    void commit_write(size_t len) {
+        if (len > m_size - m_len) {
+            len = m_size - m_len;
+        }
+
+        m_tail = wrap(m_tail + len);
+        m_len += len;
+    }
+
     /// @brief get the current size of the buffer
     /// @return the size of the buffer in bytes
     size_t size() {
@@ -116,6 +212,23 @@ protected:
                                                              m_overwrite(overwrite) {};
 
 private:
+    // helper function to copy data, a call to memcpy costs more than a few
+    // bytes do (e.g. a UART pushing one at a time)
+    static void copy(uint8_t* dst, const uint8_t* src, size_t len) {
+        if (len <= 8) {
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = src[i];
+            }
+        } else {
+            memcpy(dst, src, len);
+        }
+    }
+
+    // helper function to wrap an index that's at most one buffer past the end
+    size_t wrap(size_t i) {
+        return (i >= m_size) ? i - m_size : i;
+    }
+
     size_t m_head;
     size_t m_tail;
     size_t m_len;
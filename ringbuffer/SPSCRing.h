@@ -0,0 +1,219 @@
+/*******************************************************************************
+*
+*  Name: SPSCRing.h
+*
+*  Purpose: Lock-free single producer, single consumer byte ring.
+*           One side (e.g. an ISR or a reader thread) writes, the other (e.g.
+*           a task) reads, with no locks and no interrupt masking.
+*
+*           The reader can ask to be told when enough data has arrived with
+*           'threshold', the writer calls the threshold function once the ring
+*           holds that much, e.g. to WAKE_ISR a blocked task.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/// @brief alignment of the reader and writer indices, on hosts they're kept
+///        on separate cache lines so the two sides don't contend
+#ifndef SPSC_RING_ALIGN
+#ifdef __linux__
+#define SPSC_RING_ALIGN 64
+#else
+#define SPSC_RING_ALIGN alignof(size_t)
+#endif
+#endif
+
+/// @brief function called by the writer when the ring reaches the threshold
+typedef void (*spsc_threshold_func_t)(void* arg);
+
+namespace alloc {
+
+/// @brief lock-free single producer, single consumer byte ring
+/// @tparam SIZE    the size of the ring in bytes, must be a power of two
+template <const size_t SIZE>
+class SPSCRing {
+public:
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "SPSCRing size must be a power of two");
+
+    /// @brief constructor
+    SPSCRing() : m_tail(0), m_head_cache(0), m_func(NULL), m_arg(NULL),
+                 m_head(0), m_tail_cache(0), m_threshold(0) {};
+
+    /// @brief set the function called when the threshold is reached
+    ///        set before the reader and writer start using the ring
+    void on_threshold(spsc_threshold_func_t func, void* arg) {
+        m_func = func;
+        m_arg = arg;
+    }
+
+    /// @brief write data into the ring, only called by the writer
+    /// @param buff     the data to write
+    /// @param len      the number of bytes to write
+    /// @return the number of bytes written, less than 'len' if the ring is full
+    size_t write(const uint8_t* buff, size_t len) {
+        size_t tail = m_tail;
+
+        if(SIZE - (tail - m_head_cache) < len) {
+            // looks full, see how much the reader has taken since
+            m_head_cache = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+
+            size_t free = SIZE - (tail - m_head_cache);
+            if(free < len) {
+                len = free;
+            }
+        }
+
+        if(0 == len) {
+            return 0;
+        }
+
+        size_t i = tail & (SIZE - 1);
+        size_t first = SIZE - i;
+        if(first > len) {
+            first = len;
+        }
+
+        copy(m_buff + i, buff, first);
+        copy(m_buff, buff + first, len - first);
+
+        // publish the data
+        __atomic_store_n(&m_tail, tail + len, __ATOMIC_RELEASE);
+
+        check_threshold(tail + len);
+        return len;
+    }
+
+    /// @brief read data out of the ring, only called by the reader
+    /// @param buff     the buffer to read into
+    /// @param len      the most bytes to read
+    /// @return the number of bytes read, less than 'len' if the ring had less
+    size_t read(uint8_t* buff, size_t len) {
+        size_t head = m_head;
+
+        if(m_tail_cache - head < len) {
+            // looks empty, see how much the writer has added since
+            m_tail_cache = __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE);
+
+            size_t avail = m_tail_cache - head;
+            if(avail < len) {
+                len = avail;
+            }
+        }
+
+        if(0 == len) {
+            return 0;
+        }
+
+        size_t i = head & (SIZE - 1);
+        size_t first = SIZE - i;
+        if(first > len) {
+            first = len;
+        }
+
+        copy(buff, m_buff + i, first);
+        copy(buff + first, m_buff, len - first);
+
+        // give the space back
+        __atomic_store_n(&m_head, head + len, __ATOMIC_RELEASE);
+        return len;
+    }
+
+    /// @brief ask the writer to call the threshold function once the ring has
+    ///        at least 'len' bytes in it, only called by the reader
+    ///        the function is called once, call this again to rearm it
+    /// @param len  the number of bytes to wait for, 0 to disarm
+    /// @return 'true' if 'len' bytes are already readable, the function won't
+    ///         be called for them, 'false' if it's armed or the writer has
+    ///         already called it, either way the function is called exactly
+    ///         once, so a reader that waits for it on 'false' isn't left
+    ///         with a wakeup it didn't wait for
+    bool threshold(size_t len) {
+        __atomic_store_n(&m_threshold, len, __ATOMIC_SEQ_CST);
+
+        // the writer publishes it's tail and then checks the threshold, we set
+        // the threshold and then check the tail, so one of us sees the other
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if(0 == len) {
+            return false;
+        }
+
+        if(__atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) - m_head >= len) {
+            // already here, disarm if the writer hasn't already fired
+            // if it has, the caller still gets (and has to wait for) the call
+            return __atomic_compare_exchange_n(&m_threshold, &len, 0, false,
+                                               __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+
+        return false;
+    }
+
+    /// @brief get the number of bytes in the ring
+    ///        exact from the reader, a lower bound from anywhere else
+    size_t size() {
+        return __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    }
+
+    /// @brief get the maximum capacity of the ring
+    /// @return the capacity in bytes
+    size_t capacity() {
+        return SIZE;
+    }
+
+private:
+    // helper function to copy data, a call to memcpy costs more than a few
+    // bytes do (e.g. an ISR writing one at a time)
+    static void copy(uint8_t* dst, const uint8_t* src, size_t len) {
+        if(len <= 8) {
+            for(size_t i = 0; i < len; i++) {
+                dst[i] = src[i];
+            }
+        } else {
+            memcpy(dst, src, len);
+        }
+    }
+
+    // helper function for the writer to fire the threshold function
+    void check_threshold(size_t tail) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        size_t len = __atomic_load_n(&m_threshold, __ATOMIC_RELAXED);
+        if(0 == len || tail - __atomic_load_n(&m_head, __ATOMIC_ACQUIRE) < len) {
+            return;
+        }
+
+        // only fire once, the reader may be disarming it right now
+        if(__atomic_compare_exchange_n(&m_threshold, &len, 0, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            if(m_func) {
+                m_func(m_arg);
+            }
+        }
+    }
+
+    // writer side
+    alignas(SPSC_RING_ALIGN) size_t m_tail; // free running, masked to index
+    size_t m_head_cache;                    // last head the writer saw
+    spsc_threshold_func_t m_func;
+    void* m_arg;
+
+    // reader side
+    alignas(SPSC_RING_ALIGN) size_t m_head; // free running, masked to index
+    size_t m_tail_cache;                    // last tail the reader saw
+    size_t m_threshold;
+
+    alignas(SPSC_RING_ALIGN) uint8_t m_buff[SIZE];
+};
+
+}
+
+#endif
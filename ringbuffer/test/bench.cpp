@@ -0,0 +1,148 @@
+// benchmarks byte throughput of the ring buffer against the byte at a time
+// implementation it replaced, and a consumer working in place through the
+// spans against one copying data out with pop
+//
+// build: g++ -O2 -I../.. bench.cpp -o bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "ringbuffer/RingBuffer.h"
+
+static const size_t TOTAL_BYTES = 256 * 1024 * 1024;
+static const size_t BUFF_SIZE = 4096;
+static const size_t CHUNKS[] = {1, 16, 256, 1500};
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// the previous implementation, one byte and one '%' at a time
+class OldRingBuffer {
+public:
+    OldRingBuffer() : m_head(0), m_tail(0), m_len(0), m_size(BUFF_SIZE) {};
+
+    size_t push(uint8_t *buff, size_t len) {
+        if (m_len + len > m_size) {
+            len = m_size - m_len;
+        }
+        m_len += len;
+
+        size_t i = 0;
+        while (i < len) {
+            m_buff[m_tail] = buff[i];
+            i++;
+            m_tail = (m_tail + 1) % m_size;
+        }
+
+        return i;
+    }
+
+    size_t pop(uint8_t *buff, size_t len) {
+        size_t i = 0;
+        while (i < len) {
+            buff[i] = m_buff[m_head];
+            i++;
+            m_head = (m_head + 1) % m_size;
+            if (m_head == m_tail) {
+                break;
+            }
+        }
+
+        m_len -= i;
+        return i;
+    }
+
+private:
+    size_t m_head;
+    size_t m_tail;
+    size_t m_len;
+    size_t m_size;
+    uint8_t m_buff[BUFF_SIZE];
+};
+
+static uint8_t src[1500];
+static uint8_t dst[1500];
+static volatile uint32_t sink;
+
+// push a chunk, pop a chunk, returns MB/s
+template <typename RB>
+double run(RB& rb, size_t chunk) {
+    // offset so chunks wrap around the end
+    rb.push(src, 7);
+    rb.pop(dst, 7);
+
+    uint64_t start = now_ns();
+    for(size_t done = 0; done < TOTAL_BYTES; done += chunk) {
+        rb.push(src, chunk);
+        rb.pop(dst, chunk);
+        sink = sink + dst[0];
+    }
+
+    return TOTAL_BYTES / ((now_ns() - start) / 1000.0);
+}
+
+// checksum consumer, copies data out then sums it, returns MB/s
+double run_copy(alloc::RingBuffer<BUFF_SIZE, false>& rb, size_t chunk) {
+    uint32_t sum = 0;
+
+    uint64_t start = now_ns();
+    for(size_t done = 0; done < TOTAL_BYTES; done += chunk) {
+        rb.push(src, chunk);
+
+        size_t len = rb.pop(dst, chunk);
+        for(size_t i = 0; i < len; i++) {
+            sum += dst[i];
+        }
+    }
+    sink = sum;
+
+    return TOTAL_BYTES / ((now_ns() - start) / 1000.0);
+}
+
+// checksum consumer, sums the data in place through the spans, returns MB/s
+double run_spans(alloc::RingBuffer<BUFF_SIZE, false>& rb, size_t chunk) {
+    ringbuffer_span_t spans[2];
+    uint32_t sum = 0;
+
+    uint64_t start = now_ns();
+    for(size_t done = 0; done < TOTAL_BYTES; done += chunk) {
+        rb.push(src, chunk);
+
+        rb.peek_spans(spans);
+        for(int s = 0; s < 2; s++) {
+            for(size_t i = 0; i < spans[s].len; i++) {
+                sum += spans[s].buff[i];
+            }
+        }
+        rb.commit_read(chunk);
+    }
+    sink = sum;
+
+    return TOTAL_BYTES / ((now_ns() - start) / 1000.0);
+}
+
+int main() {
+    static OldRingBuffer old_rb;
+    static alloc::RingBuffer<BUFF_SIZE, false> rb;
+
+    for(size_t i = 0; i < sizeof(src); i++) {
+        src[i] = i;
+    }
+
+    // push then pop, MB/s
+    printf("chunk       old    memcpy    | checksum: pop+sum  in place\n");
+    for(size_t chunk : CHUNKS) {
+        double old_mbs = run(old_rb, chunk);
+        double new_mbs = run(rb, chunk);
+        double copy_mbs = run_copy(rb, chunk);
+        double span_mbs = run_spans(rb, chunk);
+
+        printf("%5lu %9.0f %9.0f    | %17.0f %9.0f\n", chunk, old_mbs, new_mbs, copy_mbs, span_mbs);
+    }
+}
@@ -0,0 +1,263 @@
+// tests the lock-free SPSC ring with a writer and a reader thread, checking
+// every byte arrives in order, and measures throughput
+//
+// build: g++ -O2 -pthread -I../.. spsc_test.cpp -o spsc_test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "ringbuffer/SPSCRing.h"
+
+static const size_t TOTAL_BYTES = 512 * 1024 * 1024;
+static const size_t STRESS_BYTES = 16 * 1024 * 1024;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+bool threshold() {
+    static alloc::SPSCRing<16> ring;
+    static int fired = 0;
+
+    ring.on_threshold([](void* arg) { (*(int*)arg)++; }, &fired);
+
+    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    if(ring.threshold(4)) {
+        printf("threshold met on empty ring\n");
+        return false;
+    }
+
+    ring.write(data, 3);
+    if(fired != 0) {
+        printf("threshold fired early\n");
+        return false;
+    }
+
+    ring.write(data, 3);
+    ring.write(data, 3);
+    if(fired != 1) {
+        printf("threshold fired %i times, expected once\n", fired);
+        return false;
+    }
+
+    // already enough, doesn't arm
+    if(!ring.threshold(4)) {
+        printf("threshold not met with 9 bytes\n");
+        return false;
+    }
+
+    ring.write(data, 1);
+    if(fired != 1) {
+        printf("threshold fired when not armed\n");
+        return false;
+    }
+
+    // full
+    if(6 != ring.write(data, 8) || 16 != ring.size()) {
+        printf("bad write on full ring\n");
+        return false;
+    }
+
+    uint8_t out[16];
+    if(16 != ring.read(out, sizeof(out)) || out[0] != 1 || out[15] != 6) {
+        printf("bad read\n");
+        return false;
+    }
+
+    return 0 == ring.size();
+}
+
+static alloc::SPSCRing<4096> ring;
+static size_t chunk;
+static size_t total;
+static volatile bool woken;
+
+// writes a counting pattern in chunks of 'chunk'
+void* writer(void*) {
+    uint8_t buff[1024];
+    uint8_t val = 0;
+    size_t sent = 0;
+
+    while(sent < total) {
+        size_t len = (total - sent < chunk) ? total - sent : chunk;
+
+        for(size_t i = 0; i < len; i++) {
+            buff[i] = val + i;
+        }
+
+        size_t done = 0;
+        while(done < len) {
+            size_t n = ring.write(buff + done, len - done);
+            if(0 == n) {
+                // full, let the reader run if it shares our core
+                sched_yield();
+            }
+            done += n;
+        }
+
+        val += len;
+        sent += len;
+    }
+
+    return NULL;
+}
+
+// reads and checks the pattern, returns the number of bad bytes
+size_t reader() {
+    uint8_t buff[1024];
+    uint8_t val = 0;
+    size_t got = 0;
+    size_t bad = 0;
+
+    while(got < total) {
+        size_t len = ring.read(buff, chunk);
+        if(0 == len) {
+            // empty, let the writer run if it shares our core
+            sched_yield();
+        }
+
+        for(size_t i = 0; i < len; i++) {
+            if(buff[i] != (uint8_t)(val + i)) {
+                bad++;
+            }
+        }
+
+        val += len;
+        got += len;
+    }
+
+    return bad;
+}
+
+bool stress() {
+    static const size_t CHUNKS[] = {1, 3, 64, 1000};
+
+    for(size_t c : CHUNKS) {
+        chunk = c;
+        total = STRESS_BYTES;
+
+        pthread_t t;
+        pthread_create(&t, NULL, &writer, NULL);
+        size_t bad = reader();
+        pthread_join(t, NULL);
+
+        if(bad) {
+            printf("%lu bad bytes with %lu byte chunks\n", bad, c);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// reader blocks on the threshold rather than spinning
+bool wakeup() {
+    static alloc::SPSCRing<256> small;
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+    small.on_threshold([](void*) {
+        pthread_mutex_lock(&lock);
+        woken = true;
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&lock);
+    }, NULL);
+
+    pthread_t t;
+    pthread_create(&t, NULL, [](void*) -> void* {
+        uint8_t byte = 0;
+        for(int i = 0; i < 100000; i++) {
+            while(0 == small.write(&byte, 1)) {
+                sched_yield();
+            }
+            byte++;
+        }
+        return NULL;
+    }, NULL);
+
+    uint8_t buff[100];
+    uint8_t val = 0;
+    int got = 0;
+    int waits = 0;
+
+    while(got < 100000) {
+        size_t want = (100000 - got < 100) ? 100000 - got : 100;
+
+        pthread_mutex_lock(&lock);
+        woken = false;
+        if(!small.threshold(want)) {
+            waits++;
+            while(!woken) {
+                pthread_cond_wait(&cond, &lock);
+            }
+        }
+        pthread_mutex_unlock(&lock);
+
+        size_t len = small.read(buff, want);
+        if(len != want) {
+            printf("woken with %lu bytes, wanted %lu\n", len, want);
+            return false;
+        }
+
+        for(size_t i = 0; i < len; i++) {
+            if(buff[i] != val++) {
+                printf("bad byte\n");
+                return false;
+            }
+        }
+
+        got += len;
+    }
+
+    pthread_join(t, NULL);
+    printf("read 100000 bytes, blocked %i times\n", waits);
+    return true;
+}
+
+void throughput() {
+    static const size_t CHUNKS[] = {1, 16, 256, 1024};
+
+    for(size_t c : CHUNKS) {
+        chunk = c;
+        total = (c < 16) ? TOTAL_BYTES / 16 : TOTAL_BYTES;
+
+        uint64_t start = now_ns();
+
+        pthread_t t;
+        pthread_create(&t, NULL, &writer, NULL);
+        reader();
+        pthread_join(t, NULL);
+
+        double mbs = total / ((now_ns() - start) / 1000.0);
+        printf("%4lu byte chunks: %.0f MB/s\n", c, mbs);
+    }
+}
+
+int main() {
+    if(threshold()) {
+        printf("passed threshold test\n");
+    } else {
+        printf("failed threshold test\n");
+    }
+
+    if(stress()) {
+        printf("passed stress test\n");
+    } else {
+        printf("failed stress test\n");
+    }
+
+    if(wakeup()) {
+        printf("passed wakeup test\n");
+    } else {
+        printf("failed wakeup test\n");
+    }
+
+    throughput();
+}
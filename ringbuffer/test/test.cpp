@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ringbuffer/RingBuffer.h"
 
@@ -11,6 +12,97 @@ uint8_t out[3];
 uint8_t test[3];
 uint8_t dummy[3];
 
+// popping a full buffer returns everything, popping an empty one nothing
+bool full_empty() {
+    alloc::RingBuffer<4, false> ring;
+    uint8_t in[4] = {1, 2, 3, 4};
+    uint8_t res[8];
+
+    if(0 != ring.pop(res, sizeof(res))) {
+        printf("popped from empty buffer\n");
+        return false;
+    }
+
+    if(4 != ring.push(in, 4) || 0 != ring.push(in, 1)) {
+        printf("bad push on full buffer\n");
+        return false;
+    }
+
+    if(4 != ring.pop(res, sizeof(res)) || 0 != memcmp(in, res, 4) || ring.size() != 0) {
+        printf("bad pop on full buffer\n");
+        return false;
+    }
+
+    return true;
+}
+
+// push and pop across the end of the storage through the spans
+bool spans() {
+    alloc::RingBuffer<8, false> ring;
+    uint8_t in[6] = {1, 2, 3, 4, 5, 6};
+    ringbuffer_span_t s[2];
+
+    // move the head and tail part way around
+    ring.push(in, 5);
+    ring.pop(in, 5);
+
+    // 3 bytes before the end, 5 after
+    if(8 != ring.reserve_spans(s) || 3 != s[0].len || 5 != s[1].len) {
+        printf("bad reserve spans %lu %lu\n", s[0].len, s[1].len);
+        return false;
+    }
+
+    for(int i = 0; i < 6; i++) {
+        if(i < 3) {
+            s[0].buff[i] = 10 + i;
+        } else {
+            s[1].buff[i - 3] = 10 + i;
+        }
+    }
+    ring.commit_write(6);
+
+    if(6 != ring.peek_spans(s) || 3 != s[0].len || 3 != s[1].len) {
+        printf("bad peek spans %lu %lu\n", s[0].len, s[1].len);
+        return false;
+    }
+
+    if(s[0].buff[0] != 10 || s[1].buff[2] != 15) {
+        printf("bad span data\n");
+        return false;
+    }
+
+    ring.commit_read(4);
+
+    uint8_t res[2];
+    if(2 != ring.pop(res, 2) || res[0] != 14 || res[1] != 15) {
+        printf("bad pop after commit\n");
+        return false;
+    }
+
+    return true;
+}
+
+// overwriting keeps the newest data
+bool overwrite() {
+    alloc::RingBuffer<4, true> ring;
+    uint8_t in[6] = {1, 2, 3, 4, 5, 6};
+    uint8_t res[4];
+
+    ring.push(in, 3);
+
+    if(6 != ring.push(in, 6) || ring.size() != 4) {
+        printf("bad overwrite push\n");
+        return false;
+    }
+
+    if(4 != ring.pop(res, 4) || res[0] != 3 || res[3] != 6) {
+        printf("overwrite did not keep newest data\n");
+        return false;
+    }
+
+    return true;
+}
+
 int main() {
     test[0] = 1;
     test[1] = 2;
@@ -38,4 +130,22 @@ int main() {
     rb.push(dummy, 3);
     rb.pop(out, 3);
     printf("%i, %i, %i\n", out[0], out[1], out[2]); // {54,55,56}
+
+    if(full_empty()) {
+        printf("passed full/empty test\n");
+    } else {
+        printf("failed full/empty test\n");
+    }
+
+    if(spans()) {
+        printf("passed spans test\n");
+    } else {
+        printf("failed spans test\n");
+    }
+
+    if(overwrite()) {
+        printf("passed overwrite test\n");
+    } else {
+        printf("failed overwrite test\n");
+    }
 }
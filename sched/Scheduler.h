@@ -0,0 +1,323 @@
+/*******************************************************************************
+*
+*  Name: Scheduler.h
+*
+*  Purpose: Declares the cooperative scheduler as a class, so more than one
+*           can exist and each is only as big as the number of tasks it runs.
+*           The 'sched_' functions in sched.h use a default instance.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#include "return.h"
+#include "sched/sched.h"
+#include "queue/queue_simple.h"
+
+// check if time 'a' is before time 'b'
+// uses the signed difference so the order is still correct when the clock
+// wraps around, as long as the times are less than 2^31 ticks apart
+static inline bool time_before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+/// @brief binary min-heap of tasks ordered by the time in member 'KEY'
+///        each task stores its index in the heap in member 'IDX' (-1 if it's
+///        not on the heap), so a task can be removed in O(log n) without
+///        searching for it
+template <uint32_t task_t::*KEY, tid_t task_t::*IDX>
+class TaskHeap {
+public:
+    /// @brief constructor
+    /// @param heap     storage for the heap, with room for every task
+    TaskHeap(task_t** heap) : m_heap(heap), m_len(0) {};
+
+    /// @brief push a task onto the heap
+    /// NOTE: the heap has room for every task, so this can't fail
+    void push(task_t* task) {
+        place(task, m_len);
+        m_len++;
+        sift_up(task->*IDX);
+    }
+
+    /// @brief remove a task from the heap
+    void remove(task_t* task) {
+        tid_t i = task->*IDX;
+        task->*IDX = -1;
+        m_len--;
+
+        if(i == m_len) {
+            // removed the last element, nothing to fix up
+            return;
+        }
+
+        // move the last task into the hole and restore the heap order
+        place(m_heap[m_len], i);
+
+        if(i > 0 && time_before(m_heap[i]->*KEY, m_heap[(i - 1) / 2]->*KEY)) {
+            sift_up(i);
+        } else {
+            sift_down(i);
+        }
+    }
+
+    /// @brief get the task with the earliest time
+    /// @return the task, or NULL if the heap is empty
+    task_t* peek() {
+        if(0 == m_len) {
+            return NULL;
+        }
+
+        return m_heap[0];
+    }
+
+private:
+    // place a task at index 'i'
+    void place(task_t* task, tid_t i) {
+        m_heap[i] = task;
+        task->*IDX = i;
+    }
+
+    // move the task at index 'i' up until it's parent is earlier
+    void sift_up(tid_t i) {
+        task_t* task = m_heap[i];
+
+        while(i > 0) {
+            tid_t parent = (i - 1) / 2;
+
+            if(!time_before(task->*KEY, m_heap[parent]->*KEY)) {
+                break;
+            }
+
+            place(m_heap[parent], i);
+            i = parent;
+        }
+
+        place(task, i);
+    }
+
+    // move the task at index 'i' down until both it's children are later
+    void sift_down(tid_t i) {
+        task_t* task = m_heap[i];
+
+        while(1) {
+            tid_t child = 2 * i + 1;
+
+            if(child >= m_len) {
+                break;
+            }
+
+            // pick the earlier child
+            if(child + 1 < m_len && time_before(m_heap[child + 1]->*KEY, m_heap[child]->*KEY)) {
+                child++;
+            }
+
+            if(!time_before(m_heap[child]->*KEY, task->*KEY)) {
+                break;
+            }
+
+            place(m_heap[child], i);
+            i = child;
+        }
+
+        place(task, i);
+    }
+
+    task_t** m_heap;
+    tid_t m_len;
+};
+
+/// @brief cooperative scheduler
+///        the 'sched_' functions are wrappers around these, see sched.h for
+///        what each does
+///        use 'alloc::Scheduler' to create one
+/// NOTE: while a scheduler is dispatching a task, the 'sched_' functions (and
+///       so the scheduler macros) act on that scheduler, otherwise they act on
+///       the default instance. 'sched_wake_isr' always acts on the default
+///       instance since an interrupt can happen during any dispatch, use
+///       'wake_isr' directly to wake a task on another scheduler.
+class Scheduler {
+public:
+    bool init(time_func_t func);
+
+    uint32_t time() {
+        return m_get_time();
+    }
+
+    tid_t start(task_func_t func, void* arg, uint8_t priority = SCHED_DEFAULT_PRIORITY);
+
+    tid_t start_periodic(task_func_t func, void* arg, uint32_t period,
+                         uint32_t deadline = 0,
+                         uint8_t priority = SCHED_DEFAULT_PRIORITY,
+                         bool edf = false);
+
+    const periodic_stats_t* periodic_stats(tid_t tid);
+
+#ifdef SCHED_PROFILE
+    bool profile_clock(time_func_t func);
+
+    const task_profile_t* profile(tid_t tid);
+
+    void trace(trace_func_t func) {
+        m_trace_func = func;
+    }
+#endif
+
+    bool next_wake(uint32_t* time);
+
+    void idle(idle_func_t func) {
+        m_idle_func = func;
+    }
+
+    void dispatch();
+
+    void sleep(tid_t tid, uint32_t time);
+
+    void wake(tid_t tid);
+
+    bool wake_isr(tid_t tid);
+
+    void block(tid_t tid);
+
+    void block_until(tid_t tid, uint32_t time);
+
+    /// @brief check if a task is ready to dispatch
+    ///        sleeping tasks aren't ready until a dispatch has woken them
+    /// @return 'true' if a task is ready or was woken by an interrupt
+    bool ready();
+
+    /// @brief check if tasks woken by 'wake_isr' are waiting to be made ready
+    ///        safe to call from any thread
+    bool isr_pending();
+
+    /// @brief get the most tasks that can run at once
+    tid_t max_tasks() {
+        return m_num_tasks;
+    }
+
+    /// @brief get the number of free TIDs
+    tid_t free_tasks() {
+        return m_num_free;
+    }
+
+protected:
+    /// @brief constructor
+    ///        use the constructor for the alloc::Scheduler instead
+    /// @param tasks        task structures, 'num_tasks' long
+    /// @param num_tasks    the most tasks that can run at once
+    /// @param sleep_heap   storage for the sleep queue, 'num_tasks' long
+    /// @param edf_heap     storage for the EDF ready queue, 'num_tasks' long
+    /// @param free_tids    storage for the free TID list, 'num_tasks' long
+    /// @param isr_ring     storage for the ISR wake ring, 'ring_size' long
+    /// @param ring_size    size of the ring, a power of two >= 'num_tasks'
+    Scheduler(task_t* tasks, tid_t num_tasks, task_t** sleep_heap,
+              task_t** edf_heap, tid_t* free_tids, tid_t* isr_ring,
+              uint32_t ring_size);
+
+private:
+    void ready_push(task_t* task);
+    void ready_remove(task_t* task);
+    task_t* ready_pop();
+
+    bool isr_ring_empty();
+    void isr_ring_drain();
+
+    task_t* alloc_task(task_func_t func, void* arg, uint8_t priority);
+    void free_task(task_t* task);
+
+    void job_done(task_t* task);
+    void wakeup_tasks(uint32_t now);
+
+    task_t* m_tasks;
+    tid_t m_num_tasks;
+
+    // stack of unused TIDs, so starting a task doesn't search for one
+    tid_t* m_free;
+    tid_t m_num_free;
+
+    // sleep queue, ordered by wake time
+    TaskHeap<&task_t::wake_time, &task_t::sleep_idx> m_sleep_q;
+
+    // ready queues, one FIFO per priority
+    // tasks are linked in through their 'ready_node', so no allocation is needed
+    SimpleQueue<task_t*> m_ready_q[SCHED_NUM_PRIORITIES];
+
+    // bitmap of non-empty ready queues
+    // bit (31 - p) is set if priority 'p' has a ready task, so counting the
+    // leading zeros gives the highest priority ready in constant time
+    uint32_t m_ready_map;
+
+    // earliest deadline first ready queue
+    // tasks started with 'edf' set are ordered by the deadline of their
+    // current job and are dispatched ahead of every priority level
+    TaskHeap<&task_t::abs_deadline, &task_t::edf_idx> m_edf_q;
+
+    // ring of tasks woken from interrupts, see 'wake_isr'
+    // multiple producers (nested interrupts, or threads on Linux) reserve a
+    // slot by moving the head then fill it, single consumer ('dispatch')
+    // empty slots hold -1 so the consumer can tell a reserved slot isn't
+    // filled yet
+    // a task is only ever on the ring once, so it can't hold more than every task
+    tid_t* m_isr_ring;
+    uint32_t m_ring_mask;
+    volatile uint32_t m_isr_head; // next slot to reserve, moved by producers
+    volatile uint32_t m_isr_tail; // next slot to read, only set by the consumer
+
+    // function to call to get system time
+    time_func_t m_get_time;
+
+    // function called when no task is ready, NULL to return right away
+    idle_func_t m_idle_func;
+
+#ifdef SCHED_PROFILE
+    // clock used to time task execution, NULL to use the scheduler clock
+    time_func_t m_prof_time;
+
+    // function called with a record of every dispatch, NULL if not tracing
+    trace_func_t m_trace_func;
+#endif
+};
+
+/// @brief get the scheduler the 'sched_' functions use outside of a dispatch
+Scheduler* sched_default();
+
+/// @brief get the scheduler the 'sched_' functions act on right now, the one
+///        dispatching or the default instance
+Scheduler* sched_active();
+
+namespace alloc {
+
+/// @brief preallocated scheduler for up to 'MAX_TASKS' tasks
+template <tid_t MAX_TASKS>
+class Scheduler : public ::Scheduler {
+public:
+    /// @brief constructor
+    Scheduler() : ::Scheduler(m_tasks, MAX_TASKS, m_sleep_heap, m_edf_heap,
+                              m_free_tids, m_isr_ring, RING_SIZE) {};
+
+private:
+    static_assert(MAX_TASKS > 0, "scheduler needs room for at least one task");
+
+    // smallest power of two that holds every task
+    static constexpr uint32_t ring_size(uint32_t n) {
+        return (n <= 1) ? 1 : 2 * ring_size((n + 1) / 2);
+    }
+
+    static constexpr uint32_t RING_SIZE = ring_size(MAX_TASKS);
+
+    task_t m_tasks[MAX_TASKS];
+    task_t* m_sleep_heap[MAX_TASKS];
+    task_t* m_edf_heap[MAX_TASKS];
+    tid_t m_free_tids[MAX_TASKS];
+    tid_t m_isr_ring[RING_SIZE];
+};
+
+}
+
+#endif
@@ -0,0 +1,510 @@
+/*******************************************************************************
+*
+*  Name: coro.h
+*
+*  Purpose: Run tasks as C++20 stackless coroutines instead of with the
+*           RESUME/CALL/SLEEP/BLOCK/YIELD macros. Locals live in the coroutine
+*           frame rather than in 'static' variables, so the same function can
+*           run in any number of tasks at once. Frames are allocated from a
+*           fixed arena owned by each task, nothing is allocated on the heap.
+*
+*           Coroutine tasks are ordinary scheduler tasks, they're dispatched by
+*           'sched_dispatch' and can be woken with 'sched_wake'/WAKE like any
+*           other task. Functions written with the macros can still be called
+*           from a coroutine with 'coro::call'.
+*
+*           Requires C++20 (-std=c++20), the rest of the scheduler does not.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef SCHED_CORO_H
+#define SCHED_CORO_H
+
+#if !defined(__cpp_impl_coroutine)
+#error "sched/coro/coro.h needs C++20 coroutines, compile with -std=c++20"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+
+#include "return.h"
+#include "sched/sched.h"
+
+class CoroTask;
+
+namespace coro {
+    /// @brief the coroutine task being resumed, NULL outside of a coroutine
+    ///        coroutine frames are allocated from this task's arena
+    inline SCHED_THREAD CoroTask* current = NULL;
+}
+
+/// @brief bump allocator for coroutine frames
+///        a task's coroutines are strictly nested, so frames are freed in the
+///        reverse order they're allocated and the arena works like a stack
+class CoroArena {
+public:
+    /// @brief constructor
+    /// @param buff     the memory to allocate from, aligned for any type
+    /// @param size     the size of 'buff' in bytes
+    CoroArena(uint8_t* buff, size_t size) : m_buff(buff), m_size(size),
+                                            m_top(0), m_high(0) {};
+
+    /// @brief allocate memory for a frame
+    /// @return the memory, or NULL if the arena is full
+    void* alloc(size_t size) {
+        size = round(size);
+
+        if(m_size - m_top < size) {
+            return NULL;
+        }
+
+        void* ret = m_buff + m_top;
+        m_top += size;
+
+        if(m_top > m_high) {
+            m_high = m_top;
+        }
+
+        return ret;
+    }
+
+    /// @brief free memory for a frame
+    ///        only the most recently allocated frame can be freed, anything
+    ///        else is kept until the arena is reset
+    void free(void* ptr, size_t size) {
+        size = round(size);
+
+        if(static_cast<uint8_t*>(ptr) + size == m_buff + m_top) {
+            m_top -= size;
+        }
+    }
+
+    /// @brief free everything
+    void reset() {
+        m_top = 0;
+    }
+
+    /// @brief get the most bytes that have been in use at once
+    size_t high_water() {
+        return m_high;
+    }
+
+    /// @brief get the size of the arena in bytes
+    size_t size() {
+        return m_size;
+    }
+
+private:
+    // round a size up so every allocation stays aligned
+    static size_t round(size_t size) {
+        const size_t align = alignof(max_align_t);
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    uint8_t* m_buff;
+    size_t m_size;
+    size_t m_top;
+    size_t m_high;
+};
+
+/// @brief coroutine returning a RetType
+///        any function returning this is a coroutine and uses 'co_return' to
+///        return and 'co_await' to sleep, block, yield, or call another one
+///        e.g. RetType ret = co_await read(buff, len);
+///        calling one only creates it, it starts running once awaited (or
+///        once its task is started if it's the top level coroutine)
+class [[nodiscard]] Coro {
+public:
+    struct promise_type {
+        // what was passed to 'co_return'
+        RetType ret = RET_SUCCESS;
+
+        // the coroutine that awaited this one, empty for the top level
+        std::coroutine_handle<> caller;
+
+        // frames are allocated from the current task's arena
+        // the arena is stored in front of the frame so it can be freed
+        // without a task being resumed (e.g. when a task is stopped)
+        static void* operator new(size_t size) noexcept;
+        static void operator delete(void* ptr, size_t size) noexcept;
+
+        // a frame that doesn't fit in the arena is returned as an empty
+        // coroutine, which evaluates to RET_ERROR when awaited
+        static Coro get_return_object_on_allocation_failure() noexcept {
+            return Coro();
+        }
+
+        Coro get_return_object() noexcept {
+            return Coro(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // don't start until awaited
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        // go back to the caller when finished
+        struct FinalAwaiter {
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> caller = h.promise().caller;
+
+                if(caller) {
+                    return caller;
+                }
+
+                // top level, return to the task dispatch function
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+
+        void return_value(RetType val) noexcept {
+            ret = val;
+        }
+
+        void unhandled_exception() noexcept {
+            ret = RET_ERROR;
+        }
+    };
+
+    /// @brief constructor, an empty coroutine
+    Coro() : m_handle() {};
+
+    /// @brief move constructor
+    Coro(Coro&& other) noexcept : m_handle(other.m_handle) {
+        other.m_handle = nullptr;
+    }
+
+    /// @brief move assignment
+    Coro& operator=(Coro&& other) noexcept {
+        if(this != &other) {
+            destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    Coro(const Coro&) = delete;
+    Coro& operator=(const Coro&) = delete;
+
+    /// @brief destructor, frees the frame
+    ~Coro() {
+        destroy();
+    }
+
+    /// @brief check if the coroutine was created
+    /// @return 'false' if its frame didn't fit in the arena
+    bool valid() {
+        return static_cast<bool>(m_handle);
+    }
+
+    /// @brief get the coroutine handle
+    std::coroutine_handle<promise_type> handle() {
+        return m_handle;
+    }
+
+    // awaiting a coroutine runs it until it returns
+    // the caller is suspended while it runs, and resumed with it's result
+    bool await_ready() noexcept {
+        return !m_handle;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        m_handle.promise().caller = caller;
+        return m_handle;
+    }
+
+    RetType await_resume() noexcept {
+        if(!m_handle) {
+            return RET_ERROR;
+        }
+
+        return m_handle.promise().ret;
+    }
+
+private:
+    explicit Coro(std::coroutine_handle<promise_type> handle) : m_handle(handle) {};
+
+    void destroy() {
+        if(m_handle) {
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/// @brief a scheduler task running a coroutine
+///        the task is dispatched like any other, each dispatch resumes the
+///        innermost coroutine from where it last suspended
+class CoroTask {
+public:
+    /// @brief top level coroutine function
+    typedef Coro (*coro_func_t)(void*);
+
+    /// @brief start running a coroutine as a task
+    ///        the task exits once the coroutine returns
+    /// @param func         the coroutine to run
+    /// @param arg          argument to pass to 'func'
+    /// @param priority     scheduling priority of the task
+    /// @return the task ID, or -1 on error (e.g. already running, out of
+    ///         tasks, or the frame doesn't fit in the arena)
+    tid_t start(coro_func_t func, void* arg, uint8_t priority = SCHED_DEFAULT_PRIORITY) {
+        if(m_root.valid()) {
+            return -1;
+        }
+
+        m_arena.reset();
+
+        // allocate the frame from our arena
+        CoroTask* prev = coro::current;
+        coro::current = this;
+        m_root = func(arg);
+        coro::current = prev;
+
+        if(!m_root.valid()) {
+            return -1;
+        }
+
+        m_resume = m_root.handle();
+
+        m_tid = sched_start(&dispatch, this, priority);
+        if(-1 == m_tid) {
+            m_root = Coro();
+        }
+
+        return m_tid;
+    }
+
+    /// @brief get the ID of the task
+    /// @return the task ID, or -1 if not started
+    tid_t tid() {
+        return m_tid;
+    }
+
+    /// @brief check if the coroutine is still running
+    bool running() {
+        return m_root.valid();
+    }
+
+    /// @brief get what the top level coroutine returned
+    ///        only meaningful once it's no longer running
+    RetType result() {
+        return m_result;
+    }
+
+    /// @brief get the arena frames are allocated from
+    CoroArena& arena() {
+        return m_arena;
+    }
+
+    /// @brief suspend the task back to the scheduler
+    ///        used by the awaitables, not called directly
+    /// @param handle   the coroutine to resume on the next dispatch
+    /// @param ret      what to return to the scheduler, RET_SLEEP, RET_BLOCKED,
+    ///                 or RET_YIELD
+    void suspend(std::coroutine_handle<> handle, RetType ret) {
+        m_resume = handle;
+        m_ret = ret;
+    }
+
+protected:
+    /// @brief constructor
+    /// @param buff     memory to allocate coroutine frames from
+    /// @param size     size of 'buff' in bytes
+    CoroTask(uint8_t* buff, size_t size) : m_arena(buff, size), m_root(),
+                                           m_resume(), m_ret(RET_SUCCESS),
+                                           m_result(RET_SUCCESS), m_tid(-1) {};
+
+private:
+    // task function, resumes the coroutine until it suspends or returns
+    static RetType dispatch(void* arg) {
+        CoroTask* self = static_cast<CoroTask*>(arg);
+
+        CoroTask* prev = coro::current;
+        coro::current = self;
+
+        // the coroutine sets this when it suspends to the scheduler
+        self->m_ret = RET_SUCCESS;
+        self->m_resume.resume();
+
+        coro::current = prev;
+
+        if(self->m_root.handle().done()) {
+            // finished, free the frames and exit the task
+            self->m_result = self->m_root.handle().promise().ret;
+            self->m_root = Coro();
+            self->m_tid = -1;
+            return RET_ERROR;
+        }
+
+        return self->m_ret;
+    }
+
+    CoroArena m_arena;
+
+    // the top level coroutine
+    Coro m_root;
+
+    // the coroutine to resume on the next dispatch
+    std::coroutine_handle<> m_resume;
+
+    // what to return to the scheduler after resuming
+    RetType m_ret;
+
+    // what the top level coroutine returned
+    RetType m_result;
+
+    tid_t m_tid;
+};
+
+inline void* Coro::promise_type::operator new(size_t size) noexcept {
+    CoroTask* task = coro::current;
+
+    if(NULL == task) {
+        // not in a coroutine task, there's nowhere to allocate from
+        return NULL;
+    }
+
+    const size_t header = alignof(max_align_t);
+    uint8_t* mem = static_cast<uint8_t*>(task->arena().alloc(size + header));
+
+    if(NULL == mem) {
+        return NULL;
+    }
+
+    *reinterpret_cast<CoroArena**>(mem) = &(task->arena());
+    return mem + header;
+}
+
+inline void Coro::promise_type::operator delete(void* ptr, size_t size) noexcept {
+    const size_t header = alignof(max_align_t);
+    uint8_t* mem = static_cast<uint8_t*>(ptr) - header;
+
+    (*reinterpret_cast<CoroArena**>(mem))->free(mem, size + header);
+}
+
+namespace alloc {
+
+/// @brief coroutine task with a 'SIZE' byte arena for its frames
+///        the arena needs to fit the deepest chain of nested coroutines the
+///        task calls, 'arena().high_water()' gives the actual use
+template <size_t SIZE>
+class CoroTask : public ::CoroTask {
+public:
+    /// @brief constructor
+    CoroTask() : ::CoroTask(m_buff, SIZE) {};
+
+private:
+    alignas(max_align_t) uint8_t m_buff[SIZE];
+};
+
+}
+
+namespace coro {
+
+/// @brief suspend the task back to the scheduler
+///        for when the scheduler has already been told what to do with it
+struct Suspend {
+    RetType ret;
+
+    bool await_ready() noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        current->suspend(h, ret);
+    }
+
+    void await_resume() noexcept {}
+};
+
+/// @brief sleep the task for 'ticks', e.g. co_await coro::sleep(10);
+struct Sleep : Suspend {
+    uint32_t ticks;
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        sched_sleep(sched_dispatched, ticks);
+        Suspend::await_suspend(h);
+    }
+};
+
+inline Sleep sleep(uint32_t ticks) {
+    return Sleep{{RET_SLEEP}, ticks};
+}
+
+/// @brief block the task until it's woken, e.g. co_await coro::block();
+struct Block : Suspend {
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        sched_block(sched_dispatched);
+        Suspend::await_suspend(h);
+    }
+};
+
+inline Block block() {
+    return Block{{RET_BLOCKED}};
+}
+
+/// @brief block the task for at most 'ticks'
+///        e.g. RetType ret = co_await coro::block_timeout(10);
+///        evaluates to RET_SUCCESS if woken, RET_TIMEOUT if 'ticks' passed
+struct BlockTimeout : Suspend {
+    uint32_t ticks;
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+        sched_block_until(sched_dispatched, sched_time() + ticks);
+        Suspend::await_suspend(h);
+    }
+
+    RetType await_resume() noexcept {
+        return sched_dispatched_task->timed_out ? RET_TIMEOUT : RET_SUCCESS;
+    }
+};
+
+inline BlockTimeout block_timeout(uint32_t ticks) {
+    return BlockTimeout{{RET_BLOCKED}, ticks};
+}
+
+/// @brief let other ready tasks run, e.g. co_await coro::yield();
+inline Suspend yield() {
+    return Suspend{RET_YIELD};
+}
+
+/// @brief call a function written with the scheduler macros
+///        'func' is called again each time the task is dispatched until it
+///        stops sleeping, blocking, or yielding, the same as CALL would
+///        e.g. RetType ret = co_await coro::call([&]{ return queue.wait(); });
+/// @param func     callable returning a RetType
+template <typename F>
+Coro call(F func) {
+    while(1) {
+        RetType ret = func();
+
+        if(RET_SLEEP != ret && RET_BLOCKED != ret && RET_YIELD != ret) {
+            co_return ret;
+        }
+
+        // it's already slept/blocked the task
+        co_await Suspend{ret};
+    }
+}
+
+}
+
+#endif
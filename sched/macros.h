@@ -22,7 +22,8 @@
 //   places. Variables are not saved between executions on the scheduler, so
 //   use statics if storing information before blocking. Be aware another task
 //   could modify this static.
-//   NOTE: a function using resume can NOT be recursive!!!
+//   Each task can nest at most SCHED_RESUME_DEPTH functions using RESUME,
+//   past that RESUME returns RET_ERROR.
 
 // RESET()
 //   Should be placed at the end of a function, before any return statements but
@@ -40,10 +41,21 @@
 //   back to the scheduler ASAP. When the task blocked is scheduled again,
 //   execution begins right after the macro.
 
+// BLOCK_TIMEOUT(T)
+//   Block the current running task until WAKE is called on it, or until 'T'
+//   ticks have passed, whichever comes first. Returns RET_BLOCKED like BLOCK.
+//   When the task is scheduled again, execution begins right after the
+//   macro, which evaluates to RET_SUCCESS if the task was woken or
+//   RET_TIMEOUT if it timed out.
+
 // WAKE(TID)
 //   Wake the task with task ID 'TID', Puts that task back on the ready queue if
 //   it is currently blocked or sleeping.
 
+// WAKE_ISR(TID)
+//   Same as WAKE, but safe to call from an interrupt. The wake is queued and
+//   the task is put on the ready queue at the start of the next dispatch.
+
 // YIELD()
 //   Yield the currently executing task's time back to the scheduler. Task stays
 //   in the ready queue but is done executing for now. Return RET_YIELD, all
@@ -70,6 +82,7 @@
 #include "sched/macros/reset.h"
 #include "sched/macros/sleep.h"
 #include "sched/macros/block.h"
+#include "sched/macros/block_timeout.h"
 #include "sched/macros/wake.h"
 #include "sched/macros/yield.h"
 #include "sched/macros/call.h"
@@ -0,0 +1,28 @@
+#ifndef SCHED_MACROS_BLOCK_TIMEOUT_H
+#define SCHED_MACROS_BLOCK_TIMEOUT_H
+
+#include "sched/sched.h"
+#include "return.h"
+
+/* The BLOCK_TIMEOUT macro.
+*  Called as RetType ret = BLOCK_TIMEOUT(T)
+*  The current task will be blocked and taken off the ready queue, but will
+*  also be woken after T ticks if nothing calls WAKE on it first. Evaluates to
+*  RET_SUCCESS if the task was woken by WAKE, or RET_TIMEOUT if T ticks passed
+*  first.
+*/
+
+#define TOKENPASTE(x, y) x ## y
+#define TOKENPASTE2(x, y) TOKENPASTE(x, y)
+
+#define BLOCK_TIMEOUT2(T, z)\
+    ({_frame.save(TOKENPASTE2(&&_block_timeout, z));\
+      sched_block_until(sched_dispatched, sched_time() + (T));\
+      return RET_BLOCKED;\
+      TOKENPASTE2(_block_timeout, z):;\
+      sched_dispatched_task->timed_out ? RET_TIMEOUT : RET_SUCCESS;})\
+
+/// @brief block the currently running task for at most 'T' ticks
+#define BLOCK_TIMEOUT(T) BLOCK_TIMEOUT2(T, __COUNTER__)
+
+#endif
@@ -11,23 +11,72 @@
 *  call to RESUME at the top.
 */
 
+/// @brief one frame on the dispatched task's continuation stack
+///        declared by RESUME, lives for the duration of the function call
+///        so the frame is popped on any return
+class ResumeFrame {
+public:
+    /// @brief constructor, pushes a frame for the calling function
+    /// @param start    address of the '_start' label of the calling function
+    ResumeFrame(void* start) : m_task(sched_dispatched_task), m_frame(NULL) {
+        if(m_task->depth >= SCHED_RESUME_DEPTH) {
+            // nested too deep, nowhere to save our execution point
+            return;
+        }
+
+        m_frame = &(m_task->frames[m_task->depth]);
+        m_task->depth++;
+
+        if(m_frame->func != start) {
+            // this task was last in a different function at this depth
+            // so this function starts from the top
+            m_frame->func = start;
+            m_frame->label = start;
+        }
+    }
+
+    /// @brief destructor, pops the frame
+    ~ResumeFrame() {
+        if(m_frame) {
+            m_task->depth--;
+        }
+    }
+
+    /// @brief check if the frame could be pushed
+    /// @return 'true' if the frame is usable, 'false' if nested too deep
+    bool valid() {
+        return m_frame != NULL;
+    }
+
+    /// @brief get the label to resume execution at
+    void* label() {
+        return m_frame->label;
+    }
+
+    /// @brief save the label to resume execution at
+    void save(void* label) {
+        m_frame->label = label;
+    }
+
+private:
+    task_t* m_task;
+    resume_frame_t* m_frame;
+};
+
 /// @brief resumes a task from where it last slept or blocked from
 ///        should be at the top of the task function
 /// NOTE: this uses the fact that we can store the address of a label as a value
 ///       that's not a C/C++ feature but is part of GCC, so we are dependent on
 ///       using GCC/G++ for these macros to work
+/// NOTE: execution points are kept on the dispatched task's continuation stack
+///       rather than a per-function table, so RAM only grows with the call
+///       depth of each task, not with the number of functions using RESUME
 #define RESUME()\
-            static bool _init = false;\
-            static void* _current[static_cast<int>(MAX_NUM_TASKS) + 1];\
-            if(!_init) {\
-                for(int i = 0; i < static_cast<int>(MAX_NUM_TASKS) + 1; i++) {\
-                    _current[i] = &&_start;\
-                }\
-                _init = true;\
+            ResumeFrame _frame(&&_start);\
+            if(!_frame.valid()) {\
+                return RET_ERROR;\
             }\
-            goto *(_current[static_cast<int>(sched_dispatched)]);\
+            goto *(_frame.label());\
             _start:\
 
-// TODO checking init feels a bit slow, not sure how else to initialize _current though
-
 #endif
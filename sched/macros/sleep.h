@@ -14,7 +14,7 @@
 
 
 #define SLEEP2(N, z)\
-            _current[static_cast<int>(sched_dispatched)] = TOKENPASTE2(&&_sleep, z);\
+            _frame.save(TOKENPASTE2(&&_sleep, z));\
             sched_sleep(sched_dispatched, N);\
             return RET_SLEEP;\
             TOKENPASTE2(_sleep, z):\
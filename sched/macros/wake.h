@@ -12,4 +12,8 @@
 /// @brief wake up a task with task ID 'TID'
 #define WAKE(TID) sched_wake(TID)
 
+/// @brief wake up a task with task ID 'TID' from an interrupt
+///        the task is made ready at the start of the next 'sched_dispatch'
+#define WAKE_ISR(TID) sched_wake_isr(TID)
+
 #endif
@@ -0,0 +1,126 @@
+/*******************************************************************************
+*
+*  Name: LinuxFdWake.h
+*
+*  Purpose: Wakes scheduler tasks when a file descriptor becomes readable.
+*           A watcher thread waits on every armed descriptor with epoll and
+*           wakes the task through 'sched_wake_isr', the same way an
+*           interrupt would on hardware.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef LINUX_FD_WAKE_H
+#define LINUX_FD_WAKE_H
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+
+#include "sched/sched.h"
+
+/// @brief signal sent to the scheduler thread to end an idle sleep early
+///        when the watcher wakes a task, the handler does nothing
+#ifndef LINUX_FD_WAKE_SIGNAL
+#define LINUX_FD_WAKE_SIGNAL SIGURG
+#endif
+
+// epoll instance every armed descriptor is registered with
+static int _linux_fd_epoll = -1;
+
+// thread running the scheduler, signalled when a task is woken
+static pthread_t _linux_fd_sched_thread;
+
+// signal handler, only here so the signal interrupts the idle sleep
+static void _linux_fd_signal(int) {}
+
+// watcher thread, wakes the task registered with each readable descriptor
+static void* _linux_fd_watch(void*) {
+    struct epoll_event events[16];
+
+    while(1) {
+        int n = epoll_wait(_linux_fd_epoll, events, 16, -1);
+
+        for(int i = 0; i < n; i++) {
+            sched_wake_isr(static_cast<tid_t>(events[i].data.u32));
+        }
+
+        // interrupt the idle sleep, if the signal lands before the sleep
+        // starts the sleep still ends within LINUX_IDLE_MAX_NS
+        if(n > 0) {
+            pthread_kill(_linux_fd_sched_thread, LINUX_FD_WAKE_SIGNAL);
+        }
+    }
+
+    return NULL;
+}
+
+// helper function to create the epoll instance and watcher thread
+// must be called from the thread running the scheduler
+static inline bool _linux_fd_start() {
+    if(-1 != _linux_fd_epoll) {
+        return true;
+    }
+
+    _linux_fd_epoll = epoll_create1(0);
+    if(-1 == _linux_fd_epoll) {
+        return false;
+    }
+
+    _linux_fd_sched_thread = pthread_self();
+
+    struct sigaction sa = {};
+    sa.sa_handler = &_linux_fd_signal;
+    sigaction(LINUX_FD_WAKE_SIGNAL, &sa, NULL);
+
+    // block the signal in the watcher, it's only for the scheduler thread
+    sigset_t mask, old;
+    sigemptyset(&mask);
+    sigaddset(&mask, LINUX_FD_WAKE_SIGNAL);
+    pthread_sigmask(SIG_BLOCK, &mask, &old);
+
+    pthread_t thread;
+    bool started = (0 == pthread_create(&thread, NULL, &_linux_fd_watch, NULL));
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if(!started) {
+        return false;
+    }
+
+    pthread_detach(thread);
+    return true;
+}
+
+/// @brief wake a task the next time a file descriptor is readable
+///        the descriptor is armed for one wake, call this again after the
+///        task has read from it to be woken again
+/// @param fd   the file descriptor to watch
+/// @param tid  the task to wake
+/// @return 'true' on success, 'false' if the descriptor can't be watched
+///         (e.g. it's a regular file)
+static inline bool linux_fd_arm(int fd, tid_t tid) {
+    if(!_linux_fd_start()) {
+        return false;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u32 = static_cast<uint32_t>(tid);
+
+    // re-arm if it's already registered, otherwise register it
+    if(0 == epoll_ctl(_linux_fd_epoll, EPOLL_CTL_MOD, fd, &ev)) {
+        return true;
+    }
+
+    if(ENOENT != errno) {
+        return false;
+    }
+
+    return (0 == epoll_ctl(_linux_fd_epoll, EPOLL_CTL_ADD, fd, &ev));
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*******************************************************************************
+*
+*  Name: LinuxIdle.h
+*
+*  Purpose: Scheduler clock and idle function for Linux hosts. When no task is
+*           ready the process sleeps until the next task wakes up, rather than
+*           spinning in 'sched_dispatch'.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef LINUX_IDLE_H
+#define LINUX_IDLE_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "sched/sched.h"
+
+/// @brief longest time to sleep in one idle call, in nanoseconds
+///        a signal (e.g. SIGIO, or one sent by another thread) ends the sleep
+///        early, but one delivered after the scheduler checked for interrupt
+///        wakes and before the sleep started is missed, this bounds how long
+///        that can stall the woken task
+#ifndef LINUX_IDLE_MAX_NS
+#define LINUX_IDLE_MAX_NS 10000000ULL
+#endif
+
+// time the scheduler clock started at
+static uint64_t _linux_sched_epoch = 0;
+
+// length of a scheduler tick
+static uint64_t _linux_sched_tick_ns = 1000000;
+
+// helper function to get the monotonic clock in nanoseconds
+static inline uint64_t _linux_sched_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/// @brief scheduler clock, ticks since 'linux_sched_init' was called
+uint32_t linux_sched_time() {
+    return (_linux_sched_ns() - _linux_sched_epoch) / _linux_sched_tick_ns;
+}
+
+/// @brief idle function, sleeps until the next task wakes or a signal arrives
+void linux_sched_idle(bool sleeping, uint32_t wake_time) {
+    uint64_t now = _linux_sched_ns();
+
+    // never sleep past the cap, even with a task sleeping, so a wake that
+    // raced the sleep is handled within LINUX_IDLE_MAX_NS
+    uint64_t target = now + LINUX_IDLE_MAX_NS;
+
+    if(sleeping) {
+        // ticks until the wake time, signed so a time that's already passed
+        // doesn't look like a time far in the future
+        uint64_t ticks = (now - _linux_sched_epoch) / _linux_sched_tick_ns;
+        int32_t delta = static_cast<int32_t>(wake_time - static_cast<uint32_t>(ticks));
+
+        if(delta <= 0) {
+            return;
+        }
+
+        uint64_t wake = _linux_sched_epoch + (ticks + delta) * _linux_sched_tick_ns;
+        if(wake < target) {
+            target = wake;
+        }
+    }
+
+    struct timespec ts;
+    ts.tv_sec = target / 1000000000ULL;
+    ts.tv_nsec = target % 1000000000ULL;
+
+    // sleep to an absolute time so the sleep doesn't drift
+    // returns early with EINTR if a signal is delivered
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/// @brief initialize the scheduler with the Linux clock and idle function
+/// @param tick_ns  length of a scheduler tick in nanoseconds
+/// @return 'true' on success, 'false' on failure
+bool linux_sched_init(uint64_t tick_ns = 1000000) {
+    if(0 == tick_ns) {
+        return false;
+    }
+
+    _linux_sched_tick_ns = tick_ns;
+    _linux_sched_epoch = _linux_sched_ns();
+
+    if(!sched_init(&linux_sched_time)) {
+        return false;
+    }
+
+    sched_idle(&linux_sched_idle);
+    return true;
+}
+
+#endif
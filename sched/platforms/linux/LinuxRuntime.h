@@ -0,0 +1,375 @@
+/*******************************************************************************
+*
+*  Name: LinuxRuntime.h
+*
+*  Purpose: Runs many schedulers ("nodes", e.g. one per simulated flight
+*           computer) on a pool of worker threads. Each worker keeps a
+*           work-stealing deque of nodes, dispatches the node at the top for a
+*           slice, then puts it back. Idle workers steal nodes from the others,
+*           so replaying many flights or nodes scales across cores.
+*
+*           A node is only ever dispatched by one worker at a time, so its
+*           tasks keep the cooperative semantics every driver is written for.
+*           Inside a task the 'sched_' functions and macros act on that task's
+*           node. To wake a task on another node (or from another thread) use
+*           'wake', which is safe from any thread.
+*
+*           Nodes on different workers run at the same time, so they must not
+*           share unlocked state. That includes statics in functions that use
+*           RESUME, e.g. a 'static WaitQueue' or buffer in a driver function.
+*           Give each node its own driver objects instead.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef LINUX_RUNTIME_H
+#define LINUX_RUNTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "sched/sched.h"
+#include "sched/Scheduler.h"
+#include "sched/platforms/linux/WorkDeque.h"
+
+/// @brief dispatches a worker makes on a node before moving to the next one
+#ifndef LINUX_RUNTIME_SLICE
+#define LINUX_RUNTIME_SLICE 64
+#endif
+
+/// @brief time a worker sleeps for when it has nothing to dispatch, in
+///        nanoseconds, so nodes that are only sleeping don't spin every core
+#ifndef LINUX_RUNTIME_IDLE_NS
+#define LINUX_RUNTIME_IDLE_NS 50000
+#endif
+
+namespace alloc {
+
+/// @brief runs up to 'MAX_NODES' schedulers on up to 'MAX_WORKERS' threads
+/// NOTE: nodes must not have an idle function set, it would stall the worker
+/// NOTE: nodes must not share statics of RESUME functions (or any other
+///       unlocked state), nodes on different workers are dispatched at once
+template <size_t MAX_NODES, size_t MAX_WORKERS = 16>
+class LinuxRuntime {
+public:
+    /// @brief constructor
+    LinuxRuntime() : m_num_nodes(0), m_num_workers(0), m_stop(false),
+                     m_done(0), m_inject_len(0) {
+        pthread_mutex_init(&m_inject_lock, NULL);
+    };
+
+    /// @brief destructor
+    ~LinuxRuntime() {
+        pthread_mutex_destroy(&m_inject_lock);
+    }
+
+    /// @brief add a node, must be called before 'run'
+    /// @param sched    the node's scheduler, with it's tasks already started
+    /// @return the node's index to pass to 'wake', or -1 if there's no room
+    int add(::Scheduler* sched) {
+        if(m_num_nodes >= MAX_NODES || NULL == sched) {
+            return -1;
+        }
+
+        node_t* node = &(m_nodes[m_num_nodes]);
+        node->sched = sched;
+        node->state = NODE_QUEUED;
+
+        return static_cast<int>(m_num_nodes++);
+    }
+
+    /// @brief wake a task on a node
+    ///        safe to call from any thread, including a task on another node
+    /// NOTE: not safe from a signal handler, use 'Scheduler::wake_isr' if the
+    ///       handler is the only thing waking tasks on that node
+    /// @param node     the node index returned by 'add'
+    /// @param tid      the task to wake
+    /// @return 'true' on success, 'false' if 'node' or 'tid' is invalid
+    bool wake(int node, tid_t tid) {
+        if(node < 0 || static_cast<size_t>(node) >= m_num_nodes) {
+            return false;
+        }
+
+        node_t* n = &(m_nodes[node]);
+
+        // the wake ring takes any number of producers at once
+        if(!n->sched->wake_isr(tid)) {
+            return false;
+        }
+
+        // the worker parking the node checks the ring after marking it
+        // parked, and we check if it's parked after filling the ring, so one
+        // of us always sees the other
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        int parked = NODE_PARKED;
+        if(__atomic_compare_exchange_n(&(n->state), &parked, NODE_QUEUED, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            inject(n);
+        }
+
+        return true;
+    }
+
+    /// @brief run every node until all of their tasks have exited, or until
+    ///        'stop' is called
+    /// @param num_workers  number of worker threads
+    /// @return 'true' on success, 'false' on failure
+    bool run(size_t num_workers) {
+        if(0 == num_workers || num_workers > MAX_WORKERS) {
+            return false;
+        }
+
+        m_num_workers = num_workers;
+        m_stop = false;
+        m_done = 0;
+        m_inject_len = 0;
+
+        for(size_t i = 0; i < num_workers; i++) {
+            worker_t* w = &(m_workers[i]);
+            w->runtime = this;
+            w->id = i;
+            w->seed = static_cast<uint32_t>(i + 1) * 2654435761U;
+            w->dispatches = 0;
+            w->steals = 0;
+
+            // empty out anything left from a run that was stopped
+            while(NULL != w->deque.pop()) {}
+        }
+
+        // deal the nodes out round robin
+        for(size_t i = 0; i < m_num_nodes; i++) {
+            m_nodes[i].state = NODE_QUEUED;
+            m_workers[i % num_workers].deque.push(&(m_nodes[i]));
+        }
+
+        size_t started = 0;
+        for(; started < num_workers; started++) {
+            worker_t* w = &(m_workers[started]);
+            if(0 != pthread_create(&(w->thread), NULL, &worker_main, w)) {
+                break;
+            }
+        }
+
+        if(started != num_workers) {
+            stop();
+        }
+
+        for(size_t i = 0; i < started; i++) {
+            pthread_join(m_workers[i].thread, NULL);
+        }
+
+        return started == num_workers;
+    }
+
+    /// @brief stop running, 'run' returns once every worker finishes it's slice
+    void stop() {
+        __atomic_store_n(&m_stop, true, __ATOMIC_RELEASE);
+    }
+
+    /// @brief get the number of dispatches a worker made during the last 'run'
+    uint64_t dispatches(size_t worker) {
+        return (worker < m_num_workers) ? m_workers[worker].dispatches : 0;
+    }
+
+    /// @brief get the number of nodes a worker stole during the last 'run'
+    uint64_t steals(size_t worker) {
+        return (worker < m_num_workers) ? m_workers[worker].steals : 0;
+    }
+
+private:
+    enum {
+        NODE_QUEUED = 0,    // on a deque or being dispatched
+        NODE_PARKED,        // every task blocked, waiting for 'wake'
+        NODE_DONE           // every task exited
+    };
+
+    typedef struct {
+        ::Scheduler* sched;
+        int state;
+    } node_t;
+
+    // smallest power of two that holds every node
+    static constexpr size_t deque_size(size_t n) {
+        return (n <= 1) ? 1 : 2 * deque_size((n + 1) / 2);
+    }
+
+    static constexpr size_t DEQUE_SIZE = deque_size(MAX_NODES);
+
+    typedef struct {
+        LinuxRuntime* runtime;
+        size_t id;
+        pthread_t thread;
+        uint32_t seed;
+        uint64_t dispatches;
+        uint64_t steals;
+        WorkDeque<node_t, DEQUE_SIZE> deque;
+    } worker_t;
+
+    // helper function to check if a node has a task to dispatch now
+    static bool runnable(::Scheduler* sched) {
+        if(sched->ready()) {
+            return true;
+        }
+
+        uint32_t wake_time;
+        return sched->next_wake(&wake_time) && !time_before(sched->time(), wake_time);
+    }
+
+    // helper function to queue a woken node for any worker to pick up
+    void inject(node_t* node) {
+        pthread_mutex_lock(&m_inject_lock);
+        m_inject[m_inject_len] = node;
+        __atomic_store_n(&m_inject_len, m_inject_len + 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&m_inject_lock);
+    }
+
+    // helper function to take a woken node, NULL if there are none
+    node_t* take_injected() {
+        if(0 == __atomic_load_n(&m_inject_len, __ATOMIC_RELAXED)) {
+            return NULL;
+        }
+
+        node_t* node = NULL;
+
+        pthread_mutex_lock(&m_inject_lock);
+        if(m_inject_len > 0) {
+            __atomic_store_n(&m_inject_len, m_inject_len - 1, __ATOMIC_RELAXED);
+            node = m_inject[m_inject_len];
+        }
+        pthread_mutex_unlock(&m_inject_lock);
+
+        return node;
+    }
+
+    // helper function to steal a node from another worker
+    node_t* steal(worker_t* w) {
+        // start at a random victim so thieves spread out
+        w->seed = w->seed * 1664525U + 1013904223U;
+        size_t start = (w->seed >> 16) % m_num_workers;
+
+        for(size_t i = 0; i < m_num_workers; i++) {
+            size_t victim = (start + i) % m_num_workers;
+
+            if(victim == w->id) {
+                continue;
+            }
+
+            node_t* node = m_workers[victim].deque.steal();
+            if(node) {
+                w->steals++;
+                return node;
+            }
+        }
+
+        return NULL;
+    }
+
+    // helper function to dispatch a node for a slice and put it back
+    // returns 'true' if any task was dispatched
+    bool run_node(worker_t* w, node_t* node) {
+        ::Scheduler* sched = node->sched;
+        bool worked = false;
+
+        for(int i = 0; i < LINUX_RUNTIME_SLICE && runnable(sched); i++) {
+            sched->dispatch();
+            w->dispatches++;
+            worked = true;
+        }
+
+        if(sched->free_tasks() == sched->max_tasks()) {
+            // every task exited
+            __atomic_store_n(&(node->state), NODE_DONE, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&m_done, 1, __ATOMIC_ACQ_REL);
+            return worked;
+        }
+
+        uint32_t wake_time;
+        if(runnable(sched) || sched->next_wake(&wake_time)) {
+            // still has work, or a task will wake up on it's own
+            w->deque.push(node);
+            return worked;
+        }
+
+        // every task is blocked, park the node until 'wake' is called
+        __atomic_store_n(&(node->state), NODE_PARKED, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        // only the ring can have changed, and another worker may already be
+        // dispatching the node, so don't look at anything else
+        if(sched->isr_pending()) {
+            // woken while we were parking it
+            int parked = NODE_PARKED;
+            if(__atomic_compare_exchange_n(&(node->state), &parked, NODE_QUEUED, false,
+                                           __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                w->deque.push(node);
+            }
+        }
+
+        return worked;
+    }
+
+    // worker thread
+    static void* worker_main(void* arg) {
+        worker_t* w = static_cast<worker_t*>(arg);
+        LinuxRuntime* rt = w->runtime;
+
+        // our own "system" task for anything RESUME'd outside of a task
+        task_t sys_task;
+        memset(&sys_task, 0, sizeof(sys_task));
+        sched_dispatched_task = &sys_task;
+
+        int idle = 0;
+
+        while(!__atomic_load_n(&(rt->m_stop), __ATOMIC_ACQUIRE) &&
+              __atomic_load_n(&(rt->m_done), __ATOMIC_ACQUIRE) < rt->m_num_nodes) {
+            // take our own nodes oldest first so they're run round robin
+            node_t* node = w->deque.steal();
+
+            if(NULL == node) {
+                node = rt->take_injected();
+            }
+
+            if(NULL == node) {
+                node = rt->steal(w);
+            }
+
+            if(NULL != node && rt->run_node(w, node)) {
+                idle = 0;
+                continue;
+            }
+
+            // nothing was dispatched, back off after going around every node
+            if(++idle > static_cast<int>(rt->m_num_nodes) + 1) {
+                struct timespec ts = {0, LINUX_RUNTIME_IDLE_NS};
+                nanosleep(&ts, NULL);
+                idle = 0;
+            }
+        }
+
+        return NULL;
+    }
+
+    node_t m_nodes[MAX_NODES];
+    size_t m_num_nodes;
+
+    worker_t m_workers[MAX_WORKERS];
+    size_t m_num_workers;
+
+    bool m_stop;
+    size_t m_done;
+
+    // nodes woken out of parking, any worker takes them
+    pthread_mutex_t m_inject_lock;
+    node_t* m_inject[MAX_NODES];
+    size_t m_inject_len;
+};
+
+}
+
+#endif
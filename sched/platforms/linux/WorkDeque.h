@@ -0,0 +1,126 @@
+/*******************************************************************************
+*
+*  Name: WorkDeque.h
+*
+*  Purpose: Chase-Lev work-stealing deque. One thread owns the deque and pushes
+*           and pops at the bottom, any thread can steal from the top.
+*           Fixed size, nothing is allocated.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef WORK_DEQUE_H
+#define WORK_DEQUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace alloc {
+
+/// @brief work-stealing deque of up to 'SIZE' pointers
+///        based on "Correct and Efficient Work-Stealing for Weak Memory
+///        Models" (Le, Pop, Cohen, Zappa Nardelli 2013), without resizing
+/// @tparam T       type pointed to
+/// @tparam SIZE    the most items in the deque, must be a power of two
+template <typename T, size_t SIZE>
+class WorkDeque {
+public:
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "WorkDeque size must be a power of two");
+
+    /// @brief constructor
+    WorkDeque() : m_top(0), m_bottom(0) {};
+
+    /// @brief push an item on the bottom, only called by the owner
+    /// @return 'false' if the deque is full
+    bool push(T* item) {
+        int64_t b = __atomic_load_n(&m_bottom, __ATOMIC_RELAXED);
+        int64_t t = __atomic_load_n(&m_top, __ATOMIC_ACQUIRE);
+
+        if(b - t >= static_cast<int64_t>(SIZE)) {
+            return false;
+        }
+
+        __atomic_store_n(&(m_items[b & (SIZE - 1)]), item, __ATOMIC_RELAXED);
+
+        // publish the item before a thief can see the new bottom
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&m_bottom, b + 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    /// @brief pop the item most recently pushed, only called by the owner
+    /// @return the item, or NULL if the deque is empty
+    T* pop() {
+        int64_t b = __atomic_load_n(&m_bottom, __ATOMIC_RELAXED) - 1;
+        __atomic_store_n(&m_bottom, b, __ATOMIC_RELAXED);
+
+        // thieves have to see the new bottom before we read the top
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int64_t t = __atomic_load_n(&m_top, __ATOMIC_RELAXED);
+
+        if(t > b) {
+            // empty
+            __atomic_store_n(&m_bottom, b + 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+
+        T* item = __atomic_load_n(&(m_items[b & (SIZE - 1)]), __ATOMIC_RELAXED);
+
+        if(t == b) {
+            // last item, race thieves for it
+            if(!__atomic_compare_exchange_n(&m_top, &t, t + 1, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                item = NULL;
+            }
+
+            __atomic_store_n(&m_bottom, b + 1, __ATOMIC_RELAXED);
+        }
+
+        return item;
+    }
+
+    /// @brief steal the oldest item, can be called by any thread
+    ///        the owner can call this too, to take items in FIFO order
+    /// @return the item, or NULL if the deque is empty or another thread
+    ///         took the item first
+    T* steal() {
+        int64_t t = __atomic_load_n(&m_top, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int64_t b = __atomic_load_n(&m_bottom, __ATOMIC_ACQUIRE);
+
+        if(t >= b) {
+            return NULL;
+        }
+
+        T* item = __atomic_load_n(&(m_items[t & (SIZE - 1)]), __ATOMIC_RELAXED);
+
+        if(!__atomic_compare_exchange_n(&m_top, &t, t + 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            // lost the race
+            return NULL;
+        }
+
+        return item;
+    }
+
+    /// @brief get the number of items, only a snapshot if other threads are
+    ///        using the deque
+    size_t size() {
+        int64_t b = __atomic_load_n(&m_bottom, __ATOMIC_RELAXED);
+        int64_t t = __atomic_load_n(&m_top, __ATOMIC_RELAXED);
+
+        return (b > t) ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    // top and bottom on their own cache lines, thieves hammer 'm_top'
+    alignas(64) int64_t m_top;
+    alignas(64) int64_t m_bottom;
+    alignas(64) T* m_items[SIZE];
+};
+
+}
+
+#endif
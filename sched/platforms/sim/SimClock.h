@@ -0,0 +1,188 @@
+/*******************************************************************************
+*
+*  Name: SimClock.h
+*
+*  Purpose: Virtual scheduler clock for simulations. Time only moves when every
+*           task is idle, and then jumps straight to the next time something
+*           happens, either a sleeping task waking up or an injected event.
+*           Tasks take no virtual time to run, so a whole flight can be
+*           replayed much faster than real time.
+*
+*           Events are functions called at a virtual time, e.g. to update a
+*           simulated sensor and wake the task reading it the way an interrupt
+*           would.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sched/sched.h"
+
+/// @brief most events that can be waiting to be injected at once
+#ifndef SIM_MAX_EVENTS
+#define SIM_MAX_EVENTS 64
+#endif
+
+/// @brief function called at an event's virtual time
+typedef void (*sim_event_func_t)(void* arg);
+
+typedef struct {
+    uint32_t time;
+    sim_event_func_t func;
+    void* arg;
+} sim_event_t;
+
+// current virtual time
+static uint32_t _sim_time = 0;
+
+// time each dispatch that runs a task costs, in ticks
+static uint32_t _sim_dispatch_ticks = 0;
+
+// events waiting to be injected, sorted latest first so the next is last
+static sim_event_t _sim_events[SIM_MAX_EVENTS];
+static size_t _sim_num_events = 0;
+
+// set by the idle function, cleared before every dispatch
+static bool _sim_idled = false;
+
+// set if the idle function had nothing to jump to, every task is blocked
+static bool _sim_stalled = false;
+
+// end of the current 'sim_run', time never jumps past it
+static uint32_t _sim_end = 0;
+
+// helper function to check if time 'a' is before time 'b', wraps around
+static inline bool _sim_before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+/// @brief scheduler clock, the current virtual time
+static uint32_t sim_sched_time() {
+    return _sim_time;
+}
+
+/// @brief inject an event at a virtual time
+///        events at the same time are injected in the order they were added
+/// @param time     the time to call 'func' at, a time that's already passed
+///                 is injected before the next dispatch
+/// @param func     the function to call
+/// @param arg      argument to pass to 'func'
+/// @return 'true' on success, 'false' if there are too many events waiting
+static inline bool sim_at(uint32_t time, sim_event_func_t func, void* arg) {
+    if(_sim_num_events >= SIM_MAX_EVENTS || NULL == func) {
+        return false;
+    }
+
+    // insertion sort, latest first
+    size_t i = _sim_num_events;
+    while(i > 0 && !_sim_before(time, _sim_events[i - 1].time)) {
+        _sim_events[i] = _sim_events[i - 1];
+        i--;
+    }
+
+    _sim_events[i].time = time;
+    _sim_events[i].func = func;
+    _sim_events[i].arg = arg;
+    _sim_num_events++;
+
+    return true;
+}
+
+/// @brief move virtual time forward, e.g. for a task modelling work that
+///        takes time to do
+static inline void sim_advance(uint32_t ticks) {
+    _sim_time += ticks;
+}
+
+/// @brief idle function, jumps to the next sleeping task or event
+static void sim_sched_idle(bool sleeping, uint32_t wake_time) {
+    _sim_idled = true;
+
+    if(!sleeping && 0 == _sim_num_events) {
+        // nothing will ever wake a task
+        _sim_stalled = true;
+        return;
+    }
+
+    uint32_t target = _sim_end;
+
+    if(sleeping && _sim_before(wake_time, target)) {
+        target = wake_time;
+    }
+
+    if(_sim_num_events > 0 && _sim_before(_sim_events[_sim_num_events - 1].time, target)) {
+        target = _sim_events[_sim_num_events - 1].time;
+    }
+
+    if(_sim_before(_sim_time, target)) {
+        _sim_time = target;
+    }
+}
+
+// helper function to inject every event that's due
+static inline void _sim_inject() {
+    while(_sim_num_events > 0 &&
+          !_sim_before(_sim_time, _sim_events[_sim_num_events - 1].time)) {
+        // take it off first, the event may add another
+        _sim_num_events--;
+        sim_event_t ev = _sim_events[_sim_num_events];
+        ev.func(ev.arg);
+    }
+}
+
+/// @brief initialize the scheduler with the virtual clock
+/// @param start            the virtual time to start at
+/// @param dispatch_ticks   virtual time each dispatch that runs a task takes
+///                         tasks that never sleep or block (e.g. continuously
+///                         polled devices) keep time from moving unless this
+///                         is set
+/// @return 'true' on success, 'false' on failure
+static inline bool sim_sched_init(uint32_t start = 0, uint32_t dispatch_ticks = 0) {
+    _sim_time = start;
+    _sim_dispatch_ticks = dispatch_ticks;
+    _sim_num_events = 0;
+
+    if(!sched_init(&sim_sched_time)) {
+        return false;
+    }
+
+    sched_idle(&sim_sched_idle);
+    return true;
+}
+
+/// @brief run the scheduler until a virtual time
+/// @param end  the time to stop at
+/// @return 'true' if 'end' was reached, 'false' if every task blocked with
+///         no event left that could wake one
+static inline bool sim_run(uint32_t end) {
+    _sim_end = end;
+    _sim_stalled = false;
+
+    while(_sim_before(_sim_time, end)) {
+        _sim_inject();
+
+        _sim_idled = false;
+        sched_dispatch();
+
+        if(_sim_stalled) {
+            return false;
+        }
+
+        if(!_sim_idled) {
+            _sim_time += _sim_dispatch_ticks;
+        }
+    }
+
+    // anything due right at the end still happens
+    _sim_inject();
+    return true;
+}
+
+#endif
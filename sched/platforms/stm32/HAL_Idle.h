@@ -0,0 +1,47 @@
+/*******************************************************************************
+*
+*  Name: HAL_Idle.h
+*
+*  Purpose: Scheduler idle function for STM32 using the HAL tick as the
+*           scheduler clock. When no task is ready the core waits for an
+*           interrupt instead of spinning in 'sched_dispatch'.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef HAL_IDLE_H
+#define HAL_IDLE_H
+
+#include "stm32f4xx_hal.h"
+
+#include "sched/sched.h"
+
+/// @brief idle function, waits for the next interrupt
+///        the SysTick interrupt fires every tick, so the core wakes at least
+///        once a tick to check the sleep queue, any device interrupt that
+///        wakes a task also ends the wait
+/// NOTE: if an ISR wakes a task between 'sched_dispatch' finding nothing ready
+///       and the WFI, the task waits until the next interrupt (at most a tick)
+void hal_sched_idle(bool sleeping, uint32_t wake_time) {
+    if(sleeping && static_cast<int32_t>(wake_time - HAL_GetTick()) <= 0) {
+        // a task is already due to wake
+        return;
+    }
+
+    __WFI();
+}
+
+/// @brief initialize the scheduler with the HAL tick and idle function
+/// @return 'true' on success, 'false' on failure
+bool hal_sched_init() {
+    if(!sched_init(&HAL_GetTick)) {
+        return false;
+    }
+
+    sched_idle(&hal_sched_idle);
+    return true;
+}
+
+#endif
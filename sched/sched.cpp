@@ -10,32 +10,23 @@
 *
 *******************************************************************************/
 #include "sched/sched.h"
-#include "queue/allocated_queue.h"
+#include "sched/Scheduler.h"
+#include "queue/queue_simple.h"
 
 // global TID for currently dispatched thread
 // a TID equal to the max num tasks represents "system" execution
-tid_t sched_dispatched = MAX_NUM_TASKS;
+SCHED_THREAD tid_t sched_dispatched = MAX_NUM_TASKS;
 
-// preallocated task structures
-static task_t tasks[MAX_NUM_TASKS];
+// task structure used for "system" execution, holds the continuation stack
+// for any RESUME'd functions called outside of a task
+static task_t sys_task;
 
-// ready queue
-static alloc::Queue<task_t*, MAX_NUM_TASKS> ready_q{};
+// task structure for currently dispatched thread
+// other threads start pointing at the same "system" task, a thread that
+// RESUMEs functions outside of a task should point it at one of its own
+SCHED_THREAD task_t* sched_dispatched_task = &sys_task;
 
-// sorting function for the sleep queue
-// sorts task_t's
-// sort by nearest wakeup time first
-bool sleep_sort(task_t*& fst, task_t*& snd) {
-    if(snd->wake_time > fst->wake_time) {
-        // first task should be dequeued before the second task
-        return true;
-    } else {
-        return false;
-    }
-}
-
-// sleep queue
-static alloc::SortedQueue<task_t*, MAX_NUM_TASKS> sleep_q{&sleep_sort};
+static_assert(SCHED_NUM_PRIORITIES <= 32, "ready map only holds 32 priorities");
 
 // dummy time function so we don't segfault if someone forgets to call 'sched_init'
 // always returns 0
@@ -43,79 +34,394 @@ uint32_t dummy_time() {
     return 0;
 }
 
-// function to call to get system time
-static time_func_t get_time = &dummy_time;
+Scheduler::Scheduler(task_t* tasks, tid_t num_tasks, task_t** sleep_heap,
+                     task_t** edf_heap, tid_t* free_tids, tid_t* isr_ring,
+                     uint32_t ring_size) :
+                     m_tasks(tasks), m_num_tasks(num_tasks), m_free(free_tids),
+                     m_num_free(0), m_sleep_q(sleep_heap), m_ready_q(),
+                     m_ready_map(0), m_edf_q(edf_heap), m_isr_ring(isr_ring),
+                     m_ring_mask(ring_size - 1), m_isr_head(0), m_isr_tail(0),
+                     m_get_time(&dummy_time), m_idle_func(NULL)
+#ifdef SCHED_PROFILE
+                     , m_prof_time(NULL), m_trace_func(NULL)
+#endif
+{
+    // push the TIDs in reverse so the lowest is handed out first
+    for(tid_t i = num_tasks - 1; i >= 0; i--) {
+        m_tasks[i].state = STATE_UNALLOCATED;
+        m_tasks[i].isr_pending = false;
+        m_free[m_num_free] = i;
+        m_num_free++;
+    }
+
+    // -1 marks a slot a producer hasn't filled yet, see 'wake_isr'
+    for(uint32_t i = 0; i < ring_size; i++) {
+        m_isr_ring[i] = -1;
+    }
+}
+
+// helper function to put a task on the back of its ready queue
+inline void Scheduler::ready_push(task_t* task) {
+    task->ready_node.data = task;
+    task->ready_loc = &(task->ready_node.data);
+
+    if(task->edf) {
+        m_edf_q.push(task);
+        return;
+    }
+
+    m_ready_q[task->priority].push_node(&(task->ready_node));
+    m_ready_map |= (0x80000000UL >> task->priority);
+}
+
+// helper function to take a task off of its ready queue
+inline void Scheduler::ready_remove(task_t* task) {
+    task->ready_loc = NULL;
+
+    if(task->edf) {
+        m_edf_q.remove(task);
+        return;
+    }
+
+    SimpleQueue<task_t*>* q = &(m_ready_q[task->priority]);
+    q->remove_node(&(task->ready_node));
+
+    if(0 == q->num_nodes()) {
+        m_ready_map &= ~(0x80000000UL >> task->priority);
+    }
+}
+
+// helper function to pop the highest priority ready task
+// returns NULL if no tasks are ready
+inline task_t* Scheduler::ready_pop() {
+    task_t* task = m_edf_q.peek();
+
+    if(NULL != task) {
+        ready_remove(task);
+        return task;
+    }
+
+    if(0 == m_ready_map) {
+        return NULL;
+    }
+
+    uint8_t priority = __builtin_clz(m_ready_map);
+    SimpleQueue<task_t*>* q = &(m_ready_q[priority]);
+    task = q->pop_node()->data;
+
+    if(0 == q->num_nodes()) {
+        m_ready_map &= ~(0x80000000UL >> priority);
+    }
+
+    task->ready_loc = NULL;
+    return task;
+}
+
+// helper function to take a task off the wait queue it's blocked on, if any
+// the task is linked in by 'WaitQueue' and taken off here so a task woken any
+// other way (a timeout, 'sched_wake', or exiting) is never left on the queue
+static inline void wait_remove(task_t* task) {
+    if(NULL != task->wait_list) {
+        task->wait_list->remove_node(&(task->wait_node));
+        task->wait_list = NULL;
+    }
+}
+
+// helper function to check if any interrupt wakes are queued
+inline bool Scheduler::isr_ring_empty() {
+    return __atomic_load_n(&m_isr_head, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&m_isr_tail, __ATOMIC_RELAXED);
+}
+
+// helper function to wake every task queued by an interrupt
+inline void Scheduler::isr_ring_drain() {
+    uint32_t head = __atomic_load_n(&m_isr_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = m_isr_tail;
+
+    while(tail != head) {
+        tid_t* slot = &(m_isr_ring[tail & m_ring_mask]);
+        tid_t tid = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+        if(-1 == tid) {
+            // reserved by an interrupt that was itself interrupted before it
+            // filled the slot, it's picked up on a later drain
+            break;
+        }
+
+        __atomic_store_n(slot, -1, __ATOMIC_RELAXED);
+        tail++;
+
+        // clear the flag before waking, if the interrupt wakes the task again
+        // after this it's queued again rather than lost
+        __atomic_store_n(&(m_tasks[tid].isr_pending), false, __ATOMIC_RELEASE);
+        wake(tid);
+    }
+
+    __atomic_store_n(&m_isr_tail, tail, __ATOMIC_RELEASE);
+}
 
 /// @brief initialize the scheduler
 /// @return 'true' on success, 'false' on failure
-bool sched_init(time_func_t func) {
+bool Scheduler::init(time_func_t func) {
+    if(!func) {
+        return false;
+    }
+
+    m_get_time = func;
+    return true;
+}
+
+#ifdef SCHED_PROFILE
+/// @brief set the clock used to time task execution
+/// @return 'true' on success, 'false' on failure
+bool Scheduler::profile_clock(time_func_t func) {
     if(!func) {
         return false;
     }
 
-    get_time = func;
+    m_prof_time = func;
+    return true;
+}
+
+/// @brief get the runtime profile of a task
+/// @return a pointer to the profile, or NULL if 'tid' is not a running task
+const task_profile_t* Scheduler::profile(tid_t tid) {
+    if(tid < 0 || tid >= m_num_tasks) {
+        return NULL;
+    }
+
+    if(STATE_UNALLOCATED == m_tasks[tid].state) {
+        return NULL;
+    }
+
+    return &(m_tasks[tid].profile);
+}
+#endif
+
+/// @brief get the time the next sleeping task wakes up
+/// @param time     set to the wake time of the next task
+/// @return 'true' if a task is sleeping, 'false' if no task is sleeping
+bool Scheduler::next_wake(uint32_t* time) {
+    task_t* task = m_sleep_q.peek();
+
+    if(NULL == task) {
+        return false;
+    }
+
+    *time = task->wake_time;
     return true;
 }
 
-/// @brief get the system time used by the scheduler
-/// @return the system time, in units of the function passed to 'sched_init'
-inline uint32_t sched_time() {
-    return get_time();
+/// @brief check if a task is ready to dispatch
+/// @return 'true' if a task is ready or was woken by an interrupt
+bool Scheduler::ready() {
+    return 0 != m_ready_map || NULL != m_edf_q.peek() || !isr_ring_empty();
+}
+
+/// @brief check if tasks woken by 'wake_isr' are waiting to be made ready
+bool Scheduler::isr_pending() {
+    return !isr_ring_empty();
+}
+
+// helper function to allocate and setup a task structure
+// returns NULL if there are no free TIDs
+task_t* Scheduler::alloc_task(task_func_t func, void* arg, uint8_t priority) {
+    if(0 == m_num_free) {
+        // we have no free TID's, too many tasks running
+        return NULL;
+    }
+
+    m_num_free--;
+    tid_t tid = m_free[m_num_free];
+
+    task_t* task = &(m_tasks[tid]);
+    task->state = STATE_ACTIVE;              // set active
+    // task->stack.curr = task->stack.block; // reset stack
+    task->func = func;
+    task->arg = arg;
+    task->tid = tid;
+    task->priority = priority;
+    task->ready_loc = NULL;
+    task->sleep_idx = -1;
+    task->timed_out = false;
+    // NOTE: 'isr_pending' is left alone, a previous task with this
+    //       TID may still be on the ISR wake ring
+    task->wait_list = NULL;
+    task->sched = this;
+    task->period = 0;
+    task->edf = false;
+    task->edf_idx = -1;
+
+#ifdef SCHED_PROFILE
+    task->profile.dispatches = 0;
+    task->profile.total_time = 0;
+    task->profile.max_time = 0;
+    task->profile.blocks = 0;
+    task->profile.sleeps = 0;
+    task->profile.yields = 0;
+#endif
+
+    // clear any execution points left by a previous task with this TID
+    task->depth = 0;
+    for(size_t j = 0; j < SCHED_RESUME_DEPTH; j++) {
+        task->frames[j].func = NULL;
+    }
+
+    return task;
+}
+
+// helper function to free a task structure and return its TID to the free list
+void Scheduler::free_task(task_t* task) {
+    wait_remove(task);
+
+    // a task can arm a sleep or timeout and then return an error, don't leave
+    // it on the sleep queue for the next task with this TID to be woken by
+    if(-1 != task->sleep_idx) {
+        m_sleep_q.remove(task);
+    }
+
+    if(-1 != task->edf_idx) {
+        m_edf_q.remove(task);
+    }
+
+    task->state = STATE_UNALLOCATED;
+
+    m_free[m_num_free] = task->tid;
+    m_num_free++;
 }
 
 /// @brief start a task on the scheduler
 /// @param func     the function to start runnning at
 /// @param arg      the argument to pass the task everytime it's executed
+/// @param priority the task priority, 0 is the highest
 /// @return the started task task id, or -1 on error
-tid_t sched_start(task_func_t func, void* arg) {
-    // find an unused task structure
-    for(tid_t i = 0; i < MAX_NUM_TASKS; i++) {
-        if(STATE_UNALLOCATED == tasks[i].state) {
-            // we found one!
-            tasks[i].state = STATE_ACTIVE;              // set active
-            // tasks[i].stack.curr = tasks[i].stack.block; // reset stack
-            tasks[i].func = func;
-            tasks[i].arg = arg;
-            tasks[i].tid = i;
-            tasks[i].sleep_loc = NULL;
-
-            // put the allocated task on the ready queue
-            // NOTE: we assume we never fail to place a task on the ready queue.
-            //       this is valid because the queue is the same size as the
-            //       number of tasks allocated.
-            tasks[i].ready_loc = ready_q.push(&(tasks[i]));
-
-            return i;
-        }
+tid_t Scheduler::start(task_func_t func, void* arg, uint8_t priority) {
+    if(priority >= SCHED_NUM_PRIORITIES) {
+        return -1;
+    }
+
+    task_t* task = alloc_task(func, arg, priority);
+
+    if(NULL == task) {
+        return -1;
+    }
+
+    // put the allocated task on the ready queue
+    ready_push(task);
+
+    return task->tid;
+}
+
+/// @brief start a periodic task on the scheduler
+/// @param func     the function to run once every period
+/// @param arg      the argument to pass the task everytime it's executed
+/// @param period   the time between releases of the task
+/// @param deadline the time after each release the task must finish by
+///                 if 0, the deadline is the period
+/// @param priority the task priority, 0 is the highest
+/// @param edf      if set, schedule earliest deadline first
+/// @return the started task task id, or -1 on error
+tid_t Scheduler::start_periodic(task_func_t func, void* arg, uint32_t period,
+                                uint32_t deadline, uint8_t priority, bool edf) {
+    if(0 == period || priority >= SCHED_NUM_PRIORITIES) {
+        return -1;
+    }
+
+    task_t* task = alloc_task(func, arg, priority);
+
+    if(NULL == task) {
+        return -1;
+    }
+
+    task->period = period;
+    task->deadline = (0 == deadline) ? period : deadline;
+    task->edf = edf;
+
+    task->stats.jobs = 0;
+    task->stats.misses = 0;
+    task->stats.skipped = 0;
+    task->stats.max_jitter = 0;
+    task->stats.total_jitter = 0;
+
+    // first job is released now
+    task->release = m_get_time();
+    task->abs_deadline = task->release + task->deadline;
+    task->job_started = false;
+
+    ready_push(task);
+
+    return task->tid;
+}
+
+/// @brief get the statistics of a periodic task
+/// @return a pointer to the statistics, or NULL if 'tid' is not periodic
+const periodic_stats_t* Scheduler::periodic_stats(tid_t tid) {
+    if(tid < 0 || tid >= m_num_tasks) {
+        return NULL;
+    }
+
+    task_t* task = &(m_tasks[tid]);
+
+    if(STATE_UNALLOCATED == task->state || 0 == task->period) {
+        return NULL;
+    }
+
+    return &(task->stats);
+}
+
+// helper function to finish the current job of a periodic task and sleep it
+// until it's next release
+void Scheduler::job_done(task_t* task) {
+    uint32_t now = m_get_time();
+
+    if(time_before(task->abs_deadline, now)) {
+        task->stats.misses++;
+    }
+
+    task->release += task->period;
+
+    // if we overran by more than a whole period, drop the releases we missed
+    // rather than running the task back to back to catch up
+    while(!time_before(now, task->release + task->period)) {
+        task->release += task->period;
+        task->stats.skipped++;
     }
 
-    // we have no free TID's, too many tasks running
-    return -1;
+    task->abs_deadline = task->release + task->deadline;
+    task->job_started = false;
+
+    // wait for the next release
+    // the release is an absolute time, so the time the job took doesn't
+    // push back the next release
+    task->state = STATE_SLEEPING;
+    task->wake_time = task->release;
+    m_sleep_q.push(task);
 }
 
 // helper function to wake up tasks in the sleep queue
-void _sched_wakeup_tasks() {
+// @param now   the current system time
+void Scheduler::wakeup_tasks(uint32_t now) {
     while(1) {
-        task_t** task_p = sleep_q.peek();
+        task_t* task = m_sleep_q.peek();
 
-        if(NULL == task_p) {
+        if(NULL == task) {
             // nothing in the sleep queue
             return;
         }
 
-        task_t* task = *task_p;
-
-        if(get_time() >= task->wake_time) {
+        if(!time_before(now, task->wake_time)) {
             // pop it off the sleep queue
-            sleep_q.pop();
+            m_sleep_q.remove(task);
+
+            // if the task was blocked, it wasn't woken before the timeout
+            task->timed_out = (STATE_BLOCKED == task->state);
+            wait_remove(task);
 
             // set active
             task->state = STATE_ACTIVE;
-            task->sleep_loc = NULL;
 
             // put it on the ready queue
-            // NOTE: we assume we can always push to the ready queue
-            task->ready_loc = ready_q.push(task);;
+            ready_push(task);
         } else {
             // this task is the earliest task we need to wake up and it isn't time yet
             return;
@@ -123,74 +429,157 @@ void _sched_wakeup_tasks() {
     }
 }
 
+// scheduler currently dispatching a task on this thread, NULL if none is
+static SCHED_THREAD Scheduler* sched_current = NULL;
+
 /// @brief dispatch the next task
-void  sched_dispatch() {
+void Scheduler::dispatch() {
+    // schedulers can dispatch from inside another's task, put everything back
+    // the way it was once this dispatch is done
+    tid_t prev_tid = sched_dispatched;
+    task_t* prev_task = sched_dispatched_task;
+    Scheduler* prev_sched = sched_current;
+    sched_current = this;
+
     while(1) {
-        // wakeup any sleeping tasks
-        _sched_wakeup_tasks();
+        // make any tasks woken by interrupts ready
+        isr_ring_drain();
 
-        task_t** task_p = ready_q.peek();
+        // wakeup any sleeping tasks
+        // only read the clock once, it may be slow to read
+        uint32_t now = m_get_time();
+        wakeup_tasks(now);
+
+        task_t* task = ready_pop();
+
+        if(NULL == task) {
+            // nothing to dispatch, let the platform sleep until the next
+            // task wakes up
+            // an interrupt may have woken a task since we drained the ring
+            if(m_idle_func && isr_ring_empty()) {
+                uint32_t wake_time = 0;
+                bool sleeping = next_wake(&wake_time);
+                m_idle_func(sleeping, wake_time);
+            }
 
-        if(NULL == task_p) {
-            // nothing to dispatch
             break;
         }
 
-        ready_q.pop();
-        task_t* task = *task_p;
-        task->ready_loc = NULL;
+        if(task->period && !task->job_started) {
+            // first dispatch of this job, measure how late it started
+            uint32_t jitter = now - task->release;
+
+            if(time_before(now, task->release)) {
+                // woken early by someone calling 'sched_wake'
+                jitter = 0;
+            }
+
+            task->job_started = true;
+            task->stats.jobs++;
+            task->stats.total_jitter += jitter;
+            if(jitter > task->stats.max_jitter) {
+                task->stats.max_jitter = jitter;
+            }
+        }
 
         // dispatch the task
         sched_dispatched = task->tid;
-        if(RET_ERROR == task->func(task->arg)) {
+        sched_dispatched_task = task;
+
+#ifdef SCHED_PROFILE
+        time_func_t clock = m_prof_time ? m_prof_time : m_get_time;
+        uint32_t start = clock();
+#endif
+
+        RetType ret = task->func(task->arg);
+
+#ifdef SCHED_PROFILE
+        uint32_t elapsed = clock() - start;
+
+        task_profile_t* prof = &(task->profile);
+        prof->dispatches++;
+        prof->total_time += elapsed;
+        if(elapsed > prof->max_time) {
+            prof->max_time = elapsed;
+        }
+
+        // check the state rather than the return, tasks can call
+        // 'sched_sleep' or 'sched_block' directly and return success
+        if(STATE_SLEEPING == task->state) {
+            prof->sleeps++;
+        } else if(STATE_BLOCKED == task->state) {
+            prof->blocks++;
+        } else if(RET_YIELD == ret) {
+            prof->yields++;
+        }
+
+        if(m_trace_func) {
+            sched_trace_t rec;
+            rec.start = start;
+            rec.duration = elapsed;
+            rec.tid = task->tid;
+            rec.ret = ret;
+            rec.state = (RET_ERROR == ret) ? STATE_UNALLOCATED : task->state;
+            m_trace_func(&rec);
+        }
+#endif
+
+        if(RET_ERROR == ret) {
             // don't put back on the ready queue
             // free this task
-            task->state = STATE_UNALLOCATED;
+            free_task(task);
             break;
         }
 
         if(STATE_ACTIVE == task->state) {
             // if the task was slept or blocked, don't put it back on the queue
 
-            task->ready_loc = ready_q.push(task);
-            // NOTE: we again assume we can always push to the ready queue
+            if(task->period && RET_SUCCESS == ret) {
+                // periodic task finished this job
+                job_done(task);
+            } else {
+                ready_push(task);
+            }
         }
 
         break;
     }
 
-    sched_dispatched = MAX_NUM_TASKS;
+    sched_dispatched = prev_tid;
+    sched_dispatched_task = prev_task;
+    sched_current = prev_sched;
 }
 
 /// @brief sleep a task
 /// @param
-void sched_sleep(tid_t tid, uint32_t time) {
-    task_t* task = &(tasks[tid]); // TODO potential memory error, tid not bounds checked
+void Scheduler::sleep(tid_t tid, uint32_t time) {
+    task_t* task = &(m_tasks[tid]); // TODO potential memory error, tid not bounds checked
 
     // if the task is already sleeping, take it off the sleep queue
     // this guarantees when it's placed back on the queue it's sorted properly
-    if(NULL != task->sleep_loc) {
-        sleep_q.remove(task->sleep_loc);
-        // new sleep_loc set later
+    if(-1 != task->sleep_idx) {
+        m_sleep_q.remove(task);
     // NOTE: this can be an else because a task cannot be on more than one queue at once
     } else if(NULL != task->ready_loc) {
     // if the task is on the ready queue, remove it
-        ready_q.remove(task->ready_loc);
-        task->ready_loc = NULL;
+        ready_remove(task);
     }
 
     // set the state and wake time
     task->state = STATE_SLEEPING;
-    task->wake_time = get_time() + time;
+    task->wake_time = m_get_time() + time;
 
     // place the task on the sleep queue
-    // NOTE: we assume we can always push
-    task->sleep_loc = sleep_q.push(task);
+    m_sleep_q.push(task);
 }
 
 /// @brief wake up a task
-void sched_wake(tid_t tid) {
-    task_t* task = &(tasks[tid]); // TODO potential memory error, tid not bounds checked
+void Scheduler::wake(tid_t tid) {
+    task_t* task = &(m_tasks[tid]); // TODO potential memory error, tid not bounds checked
+
+    // always take the task off any wait queue, even if it's already awake
+    // 'WaitQueue' relies on this to pop its waiters
+    wait_remove(task);
 
     if(STATE_BLOCKED != task->state && STATE_SLEEPING != task->state) {
         // this task is already woken and not blocked
@@ -203,35 +592,166 @@ void sched_wake(tid_t tid) {
     }
 
     // if the task is on the sleep queue, remove it
-    if(NULL != task->sleep_loc) {
-        sleep_q.remove(task->sleep_loc);
-        task->sleep_loc = NULL;
+    if(-1 != task->sleep_idx) {
+        m_sleep_q.remove(task);
     }
 
     // put it on the ready queue
-    // NOTE: we assume we can always push
-    task->ready_loc = ready_q.push(task);
+    ready_push(task);
     task->state = STATE_ACTIVE;
+    task->timed_out = false;
+}
+
+/// @brief wake up a task from an interrupt
+bool Scheduler::wake_isr(tid_t tid) {
+    if(tid < 0 || tid >= m_num_tasks) {
+        return false;
+    }
+
+    // only queue the task once, if it's already queued the wake will happen
+    if(__atomic_exchange_n(&(m_tasks[tid].isr_pending), true, __ATOMIC_ACQ_REL)) {
+        return true;
+    }
+
+    // reserve a slot, nested interrupts (and threads on Linux) can race here
+    uint32_t head = __atomic_load_n(&m_isr_head, __ATOMIC_RELAXED);
+    do {
+        if(head - __atomic_load_n(&m_isr_tail, __ATOMIC_ACQUIRE) > m_ring_mask) {
+            // can't happen with one entry per task, but don't overwrite a slot
+            __atomic_store_n(&(m_tasks[tid].isr_pending), false, __ATOMIC_RELEASE);
+            return false;
+        }
+    } while(!__atomic_compare_exchange_n(&m_isr_head, &head, head + 1, true,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    // then fill it, the consumer stops at a reserved slot until it's filled
+    __atomic_store_n(&(m_isr_ring[head & m_ring_mask]), tid, __ATOMIC_RELEASE);
+    return true;
 }
 
 /// @brief block a task
 ///        task will not be dispatched until 'sched_wake' is called
-void sched_block(tid_t tid) {
-    task_t* task = &(tasks[tid]); // TODO potential memory error, tid not bounds checked
+void Scheduler::block(tid_t tid) {
+    task_t* task = &(m_tasks[tid]); // TODO potential memory error, tid not bounds checked
 
     // remove this task from any queues it's on
     // NOTE: this is an else if because a task should only ever be on one queue
     if(NULL != task->ready_loc) {
-        ready_q.remove(task->ready_loc);
-        task->ready_loc = NULL;
-    } else if(NULL != task->sleep_loc) {
-        sleep_q.remove(task->sleep_loc);
-        task->sleep_loc = NULL;
+        ready_remove(task);
+    } else if(-1 != task->sleep_idx) {
+        m_sleep_q.remove(task);
     }
 
     task->state = STATE_BLOCKED;
 }
 
+/// @brief block a task until it's woken or until 'time', whichever is first
+void Scheduler::block_until(tid_t tid, uint32_t time) {
+    task_t* task = &(m_tasks[tid]); // TODO potential memory error, tid not bounds checked
+
+    // remove this task from any queues it's on
+    if(NULL != task->ready_loc) {
+        ready_remove(task);
+    } else if(-1 != task->sleep_idx) {
+        m_sleep_q.remove(task);
+    }
+
+    // block the task, but also place it on the sleep queue
+    // whichever of 'sched_wake' or the wakeup pass gets to it first wakes it
+    task->state = STATE_BLOCKED;
+    task->timed_out = false;
+    task->wake_time = time;
+    m_sleep_q.push(task);
+}
+
+// default scheduler, used by the 'sched_' functions outside of a dispatch
+static alloc::Scheduler<MAX_NUM_TASKS> default_sched;
+
+/// @brief get the scheduler the 'sched_' functions use outside of a dispatch
+Scheduler* sched_default() {
+    return &default_sched;
+}
+
+// helper function to get the scheduler the 'sched_' functions act on
+// the one dispatching the current task, or the default one outside a task
+static inline Scheduler* active() {
+    return sched_current ? sched_current : &default_sched;
+}
+
+/// @brief get the scheduler the 'sched_' functions act on
+Scheduler* sched_active() {
+    return active();
+}
+
+bool sched_init(time_func_t func) {
+    return active()->init(func);
+}
+
+uint32_t sched_time() {
+    return active()->time();
+}
+
+tid_t sched_start(task_func_t func, void* arg, uint8_t priority) {
+    return active()->start(func, arg, priority);
+}
+
+tid_t sched_start_periodic(task_func_t func, void* arg, uint32_t period,
+                           uint32_t deadline, uint8_t priority, bool edf) {
+    return active()->start_periodic(func, arg, period, deadline, priority, edf);
+}
+
+const periodic_stats_t* sched_periodic_stats(tid_t tid) {
+    return active()->periodic_stats(tid);
+}
+
+#ifdef SCHED_PROFILE
+bool sched_profile_clock(time_func_t func) {
+    return active()->profile_clock(func);
+}
+
+const task_profile_t* sched_profile(tid_t tid) {
+    return active()->profile(tid);
+}
+
+void sched_trace(trace_func_t func) {
+    active()->trace(func);
+}
+#endif
+
+bool sched_next_wake(uint32_t* time) {
+    return active()->next_wake(time);
+}
+
+void sched_idle(idle_func_t func) {
+    active()->idle(func);
+}
+
+void sched_dispatch() {
+    active()->dispatch();
+}
+
+void sched_sleep(tid_t tid, uint32_t time) {
+    active()->sleep(tid, time);
+}
+
+void sched_wake(tid_t tid) {
+    active()->wake(tid);
+}
+
+bool sched_wake_isr(tid_t tid) {
+    // an interrupt can arrive during any scheduler's dispatch, so always
+    // use the default one rather than whichever is dispatching
+    return default_sched.wake_isr(tid);
+}
+
+void sched_block(tid_t tid) {
+    active()->block(tid);
+}
+
+void sched_block_until(tid_t tid, uint32_t time) {
+    active()->block_until(tid, time);
+}
+
 // /// @brief save a variable to a task
 // template <typename T>
 // void sched_save(tid_t tid, T* var) {
@@ -3,6 +3,8 @@
 *  Name: sched.h
 *
 *  Purpose: Declares functions to use the cooperative scheduler.
+*           These act on a default scheduler of 'MAX_NUM_TASKS' tasks, see
+*           Scheduler.h to create more, or smaller, schedulers.
 *
 *  Author: Will Merges
 *
@@ -15,14 +17,26 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include "config.h"
 #include "return.h"
+#include "queue/queue_node.h"
+#include "queue/queue_simple.h"
 
 /// @brief task id, any tid < 0 or > MAX_NUM_TASKS is an error
 ///        a tid equal to MAX_NUM_TASKS represents no task executing
 typedef int tid_t;
 
+/// @brief storage for the dispatch state below
+///        on Linux several threads can each dispatch their own schedulers at
+///        once (see platforms/linux/LinuxRuntime.h), so it's per thread
+#ifdef __linux__
+#define SCHED_THREAD __thread
+#else
+#define SCHED_THREAD
+#endif
+
 /// @brief TID of currently dispatched task
-extern tid_t sched_dispatched;
+extern SCHED_THREAD tid_t sched_dispatched;
 
 /// @brief function type to get system time
 ///        units are arbitrary, same units as sleep
@@ -31,9 +45,37 @@ typedef uint32_t (*time_func_t)();
 /// @brief task function type
 typedef RetType (*task_func_t)(void* arg);
 
+/// @brief function called when no task is ready to dispatch
+///        should put the processor to sleep until 'wake_time' or until an
+///        interrupt/signal could have woken a task, whichever is first
+/// @param sleeping     'true' if a task is sleeping, 'false' if every task is
+///                     blocked and only an external event can wake one
+/// @param wake_time    the time the next sleeping task wakes up, only valid
+///                     if 'sleeping' is set
+typedef void (*idle_func_t)(bool sleeping, uint32_t wake_time);
+
 // constants
 // static const size_t SAVE_BLOCK_SIZE = 256;
-static const tid_t MAX_NUM_TASKS = 64;
+
+/// @brief number of tasks the default scheduler has room for
+///        define it for every file (e.g. -DMAX_NUM_TASKS=16) to size the
+///        default scheduler for the application, other schedulers are sized
+///        by 'alloc::Scheduler'
+#ifndef MAX_NUM_TASKS
+#define MAX_NUM_TASKS 64
+#endif
+
+/// @brief number of task priorities, 0 is the highest priority
+static const uint8_t SCHED_NUM_PRIORITIES = 32;
+
+/// @brief priority tasks are started at if none is given
+static const uint8_t SCHED_DEFAULT_PRIORITY = 16;
+
+/// @brief maximum number of RESUME'd functions that can be nested in one task
+///        e.g. a task that CALLs a driver that CALLs a semaphore is 3 deep
+#ifndef SCHED_RESUME_DEPTH
+#define SCHED_RESUME_DEPTH 16
+#endif
 
 /// @brief save stack
 ///        used for storing variables from a task
@@ -50,6 +92,48 @@ typedef enum {
     STATE_BLOCKED
 } state_t;
 
+/// @brief saved execution point of one RESUME'd function in a task's call chain
+typedef struct {
+    void* func;     // identifies the function, address of its '_start' label
+    void* label;    // label to resume execution at in that function
+} resume_frame_t;
+
+/// @brief statistics kept for periodic tasks
+typedef struct {
+    uint32_t jobs;          // number of jobs started
+    uint32_t misses;        // number of jobs that finished after their deadline
+    uint32_t skipped;       // number of releases dropped because a job overran
+    uint32_t max_jitter;    // worst time between a release and the job starting
+    uint64_t total_jitter;  // sum of release jitter, mean is 'total_jitter' / 'jobs'
+} periodic_stats_t;
+
+#ifdef SCHED_PROFILE
+/// @brief runtime profile of a task
+///        times are in units of the profiling clock, see 'sched_profile_clock'
+typedef struct {
+    uint32_t dispatches;    // number of times the task was dispatched
+    uint64_t total_time;    // total time spent executing the task
+    uint32_t max_time;      // longest single dispatch
+    uint32_t blocks;        // number of dispatches that ended blocked
+    uint32_t sleeps;        // number of dispatches that ended sleeping
+    uint32_t yields;        // number of dispatches that ended in a yield
+} task_profile_t;
+
+/// @brief record of a single dispatch, passed to the trace function
+typedef struct {
+    uint32_t start;         // profiling clock time the dispatch started
+    uint32_t duration;      // profiling clock time the dispatch took
+    int16_t tid;            // the task dispatched
+    uint8_t ret;            // RetType the task returned
+    uint8_t state;          // state_t the task was left in
+} sched_trace_t;
+
+/// @brief function called after every dispatch when tracing
+typedef void (*trace_func_t)(const sched_trace_t* rec);
+#endif
+
+class Scheduler;
+
 /// @brief task information
 typedef struct task_s {
     state_t state;
@@ -57,11 +141,41 @@ typedef struct task_s {
     task_func_t func;
     void* arg;
     tid_t tid;
+    uint8_t priority;
     uint32_t wake_time;
+    Node<struct task_s*> ready_node; // links the task into its priority's ready queue
     struct task_s** ready_loc; // address of the task pointer on the ready queue
-    struct task_s** sleep_loc; // address of the task pointer on the ready queue
+    tid_t sleep_idx; // index of the task in the sleep heap, -1 if not sleeping
+    bool timed_out;  // if the last block with a timeout ended by timing out
+    volatile bool isr_pending; // if the task is queued on the ISR wake ring
+    Node<struct task_s*> wait_node; // links the task into a wait queue it's blocked on
+    SimpleQueue<struct task_s*>* wait_list; // the wait queue the task is on, NULL if none
+    Scheduler* sched; // the scheduler running the task, wait queues wake through it
+
+    // periodic task information, 'period' is 0 for non-periodic tasks
+    uint32_t period;
+    uint32_t deadline;      // deadline relative to each release
+    uint32_t release;       // release time of the current job
+    uint32_t abs_deadline;  // deadline of the current job
+    bool job_started;       // if the current job has been dispatched yet
+    bool edf;               // if the task is scheduled earliest deadline first
+    tid_t edf_idx;          // index of the task in the EDF ready heap, -1 if not on it
+    periodic_stats_t stats;
+
+#ifdef SCHED_PROFILE
+    task_profile_t profile;
+#endif
+
+    // continuation stack used by the RESUME macros
+    // frame 'i' is the 'i'th RESUME'd function down the task's call chain
+    resume_frame_t frames[SCHED_RESUME_DEPTH];
+    uint8_t depth; // number of RESUME'd functions currently executing
 } task_t;
 
+/// @brief task structure of the currently dispatched task
+///        points to a "system" task when no task is dispatched
+extern SCHED_THREAD task_t* sched_dispatched_task;
+
 /// @brief initialize the scheduler
 /// @return 'true' on success, 'false' on failure
 bool sched_init(time_func_t func);
@@ -73,10 +187,64 @@ uint32_t sched_time();
 /// @brief start a task on the scheduler
 /// @param func     the task function
 /// @param arg      the argument to pass the task everytime it's executed
+/// @param priority the task priority, 0 is the highest
+///                 the highest priority ready task is always dispatched next,
+///                 tasks of the same priority are dispatched round robin
 /// @return the started task task id, or -1 on error
-tid_t sched_start(task_func_t func, void* arg);
+tid_t sched_start(task_func_t func, void* arg, uint8_t priority = SCHED_DEFAULT_PRIORITY);
+
+/// @brief start a periodic task on the scheduler
+///        the task function is called once per job, returning RET_SUCCESS
+///        finishes the job and the task sleeps until the next release.
+///        Releases are at absolute times, 'period' apart, so they don't drift
+///        with the time each job takes. Jobs can still CALL, SLEEP, BLOCK, or
+///        YIELD, the job just finishes later.
+/// @param func     the function to run once every period
+/// @param arg      the argument to pass the task everytime it's executed
+/// @param period   the time between releases of the task
+/// @param deadline the time after each release the job must finish by
+///                 if 0, the deadline is the period
+/// @param priority the task priority, 0 is the highest
+/// @param edf      if set, the task is scheduled earliest deadline first with
+///                 the other 'edf' tasks, ahead of every priority level
+/// @return the started task task id, or -1 on error
+tid_t sched_start_periodic(task_func_t func, void* arg, uint32_t period,
+                           uint32_t deadline = 0,
+                           uint8_t priority = SCHED_DEFAULT_PRIORITY,
+                           bool edf = false);
+
+/// @brief get the statistics of a periodic task
+/// @return a pointer to the statistics, or NULL if 'tid' is not periodic
+const periodic_stats_t* sched_periodic_stats(tid_t tid);
+
+#ifdef SCHED_PROFILE
+/// @brief set the clock used to time task execution
+///        defaults to the scheduler clock, a cycle counter gives better
+///        resolution (e.g. DWT->CYCCNT on STM32)
+/// @return 'true' on success, 'false' on failure
+bool sched_profile_clock(time_func_t func);
+
+/// @brief get the runtime profile of a task
+/// @return a pointer to the profile, or NULL if 'tid' is not a running task
+const task_profile_t* sched_profile(tid_t tid);
+
+/// @brief set a function to be called with a record of every dispatch
+/// @param func     the trace function, or NULL to stop tracing
+void sched_trace(trace_func_t func);
+#endif
+
+/// @brief get the time the next sleeping task wakes up
+/// @param time     set to the wake time of the next task
+/// @return 'true' if a task is sleeping, 'false' if no task is sleeping
+bool sched_next_wake(uint32_t* time);
+
+/// @brief set a function to be called when no task is ready to dispatch
+///        instead of returning right away and having the caller spin
+/// @param func     the idle function, or NULL to return right away
+void sched_idle(idle_func_t func);
 
 /// @brief dispatch the next task
+///        if no task is ready, calls the idle function (if one is set)
 void sched_dispatch();
 
 /// @brief sleep a task
@@ -86,10 +254,28 @@ void sched_sleep(tid_t tid, uint32_t time);
 /// @brief wake up a task
 void sched_wake(tid_t tid);
 
+/// @brief wake up a task from an interrupt (or signal handler, or thread)
+///        queues the wake on a lock-free ring that 'sched_dispatch' drains
+///        before picking the next task, so the task is ready on the very next
+///        dispatch without a task polling for the interrupt
+///        waking a task already queued does nothing, so the ring never fills
+///        safe to call from nested interrupts of any priority and from more
+///        than one thread at once
+/// @return 'true' on success, 'false' if 'tid' is invalid
+bool sched_wake_isr(tid_t tid);
+
 /// @brief block a task
 ///        task will not be dispatched until 'sched_wake' is called
 void sched_block(tid_t tid);
 
+/// @brief block a task until it's woken or until 'time', whichever is first
+///        the task is on the sleep queue while blocked, if the time is
+///        reached before 'sched_wake' is called the task is woken with
+///        'timed_out' set
+/// @param tid      the task to block
+/// @param time     absolute time to wake the task at if it isn't woken first
+void sched_block_until(tid_t tid, uint32_t time);
+
 // /// @brief save a variable to a task
 // template <typename T>
 // void sched_save(tid_t tid, T* var);
@@ -0,0 +1,138 @@
+// tests BLOCK_TIMEOUT resumes a task as soon as it's woken, or after the
+// timeout if it isn't woken
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+static RetType result;
+static uint32_t resumed_at;
+static bool done;
+
+RetType waiter(void*) {
+    RESUME();
+
+    result = BLOCK_TIMEOUT(10);
+    resumed_at = tick;
+    done = true;
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+// arms a timeout and then exits
+RetType quitter(void*) {
+    sched_block_until(sched_dispatched, tick + 5);
+    return RET_ERROR;
+}
+
+static bool blocked_woken;
+
+// blocks with no timeout
+RetType blocker(void*) {
+    RESUME();
+
+    BLOCK();
+    blocked_woken = true;
+
+    RESET();
+    return RET_ERROR;
+}
+
+// a task that exits with a timeout armed must not leave it for the next task
+// given its TID
+bool stale_test() {
+    tick = 0;
+
+    tid_t fst = sched_start(&quitter, NULL);
+    sched_dispatch();
+
+    blocked_woken = false;
+    tid_t snd = sched_start(&blocker, NULL);
+    if(snd != fst) {
+        printf("TID not reused, %i then %i\n", fst, snd);
+        return false;
+    }
+
+    for(; tick < 20; tick++) {
+        sched_dispatch();
+    }
+
+    if(blocked_woken) {
+        printf("woken by the previous task's timeout\n");
+        return false;
+    }
+
+    // clean up
+    WAKE(snd);
+    sched_dispatch();
+
+    return blocked_woken;
+}
+
+// runs the waiter, waking it at 'wake_at' (or never if -1)
+bool run(int wake_at, RetType expected, uint32_t expected_time) {
+    tick = 0;
+    done = false;
+
+    tid_t tid = sched_start(&waiter, NULL);
+    if(tid < 0) {
+        printf("failed to start task\n");
+        return false;
+    }
+
+    while(!done && tick < 100) {
+        if((int)tick == wake_at) {
+            WAKE(tid);
+        }
+
+        sched_dispatch();
+        if(!done) {
+            tick++;
+        }
+    }
+
+    if(!done) {
+        printf("task never resumed\n");
+        return false;
+    }
+
+    if(result != expected || resumed_at != expected_time) {
+        printf("resumed at %u with %i, expected %u with %i\n",
+               resumed_at, result, expected_time, expected);
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(run(3, RET_SUCCESS, 3)) {
+        printf("passed early wake test\n");
+    } else {
+        printf("failed early wake test\n");
+    }
+
+    if(run(-1, RET_TIMEOUT, 10)) {
+        printf("passed timeout test\n");
+    } else {
+        printf("failed timeout test\n");
+    }
+
+    if(stale_test()) {
+        printf("passed stale timeout test\n");
+    } else {
+        printf("failed stale timeout test\n");
+    }
+}
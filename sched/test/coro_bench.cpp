@@ -0,0 +1,143 @@
+// benchmarks resuming a task written with the scheduler macros against the same
+// task written as a coroutine, yielding from a few levels of nested calls, and
+// compares the RAM each needs per task
+//
+// build: g++ -O2 -std=c++20 -I../.. ../sched.cpp coro_bench.cpp -o coro_bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "sched/macros.h"
+#include "sched/coro/coro.h"
+
+static const int NUM_TASKS = 8;
+static const int NUM_DISPATCHES = 1000000;
+
+uint32_t systime() {
+    return 0;
+}
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// set to make all tasks exit
+static bool stop;
+
+static volatile uint32_t sink;
+
+// macro version, locals that live across a yield have to be static
+// and are shared by every task running the function
+RetType macro_leaf() {
+    RESUME();
+
+    static int i;
+    for(i = 0; i < 4; i++) {
+        sink = sink + i;
+        YIELD();
+    }
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+RetType macro_mid() {
+    RESUME();
+
+    CALL(macro_leaf());
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+RetType macro_task(void*) {
+    RESUME();
+
+    while(!stop) {
+        CALL(macro_mid());
+    }
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+// coroutine version, every task has it's own locals
+Coro coro_leaf() {
+    for(int i = 0; i < 4; i++) {
+        sink = sink + i;
+        co_await coro::yield();
+    }
+
+    co_return RET_SUCCESS;
+}
+
+Coro coro_mid() {
+    co_return co_await coro_leaf();
+}
+
+Coro coro_task(void*) {
+    while(!stop) {
+        co_await coro_mid();
+    }
+
+    co_return RET_SUCCESS;
+}
+
+// run the scheduler and return the time per dispatch
+double run() {
+    uint64_t start = now_ns();
+
+    for(int i = 0; i < NUM_DISPATCHES; i++) {
+        sched_dispatch();
+    }
+
+    double ns = (double)(now_ns() - start) / NUM_DISPATCHES;
+
+    stop = true;
+    for(int i = 0; i < NUM_TASKS * 10; i++) {
+        sched_dispatch();
+    }
+    stop = false;
+
+    return ns;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    for(int i = 0; i < NUM_TASKS; i++) {
+        sched_start(&macro_task, NULL);
+    }
+
+    double macro_ns = run();
+
+    alloc::CoroTask<512> tasks[NUM_TASKS];
+    for(int i = 0; i < NUM_TASKS; i++) {
+        tasks[i].start(&coro_task, NULL);
+    }
+
+    double coro_ns = run();
+
+    size_t arena = 0;
+    for(int i = 0; i < NUM_TASKS; i++) {
+        if(tasks[i].arena().high_water() > arena) {
+            arena = tasks[i].arena().high_water();
+        }
+    }
+
+    // every task reserves a continuation stack whether it uses it or not
+    size_t frames = sizeof(resume_frame_t) * SCHED_RESUME_DEPTH;
+
+    printf("%i tasks yielding 3 calls deep, %i dispatches\n", NUM_TASKS, NUM_DISPATCHES);
+    printf("macros:     %6.1f ns per dispatch\n", macro_ns);
+    printf("coroutines: %6.1f ns per dispatch\n", coro_ns);
+    printf("RAM per task: macros %lu bytes of continuation stack (+ shared statics), "
+           "coroutines %lu bytes of arena used + %lu bytes of task object\n",
+           frames, arena, sizeof(CoroTask));
+}
@@ -0,0 +1,240 @@
+// tests coroutine tasks: the same coroutine running in several tasks at once,
+// sleeping, blocking and waking through the scheduler, calling functions
+// written with the macros, and running out of arena
+//
+// build: g++ -std=c++20 -I../.. ../sched.cpp coro_test.cpp -o coro_test
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+#include "sched/coro/coro.h"
+#include "sync/WaitQueue.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+void run(int n) {
+    for(int i = 0; i < n; i++) {
+        sched_dispatch();
+    }
+}
+
+static const int NUM_TASKS = 3;
+
+// nested coroutine, adds to a running total
+Coro add(int* total, int val) {
+    co_await coro::yield();
+    *total += val;
+    co_return RET_SUCCESS;
+}
+
+// the same 'driver' run by every task, all state is local
+Coro count(void* arg) {
+    int id = (int)(size_t)arg;
+    int total = 0;
+
+    for(int i = 0; i <= 10; i++) {
+        if(RET_SUCCESS != co_await add(&total, i * (id + 1))) {
+            co_return RET_ERROR;
+        }
+
+        co_await coro::sleep(1);
+    }
+
+    co_return (total == 55 * (id + 1)) ? RET_SUCCESS : RET_ERROR;
+}
+
+bool reentrant_test() {
+    alloc::CoroTask<256> tasks[NUM_TASKS];
+
+    for(int i = 0; i < NUM_TASKS; i++) {
+        if(-1 == tasks[i].start(&count, (void*)(size_t)i)) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    for(int t = 0; t < 20; t++) {
+        run(NUM_TASKS * 3);
+        tick++;
+    }
+
+    for(int i = 0; i < NUM_TASKS; i++) {
+        if(tasks[i].running() || RET_SUCCESS != tasks[i].result()) {
+            printf("task %i counted wrong\n", i);
+            return false;
+        }
+
+        if(0 == tasks[i].arena().high_water()) {
+            printf("task %i never used it's arena\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int woken = 0;
+static RetType block_ret;
+
+Coro blocker(void*) {
+    co_await coro::block();
+    woken++;
+
+    block_ret = co_await coro::block_timeout(5);
+    woken++;
+
+    co_return RET_SUCCESS;
+}
+
+bool block_test() {
+    alloc::CoroTask<128> task;
+    woken = 0;
+    tick = 0;
+
+    tid_t tid = task.start(&blocker, NULL);
+    run(5);
+
+    if(0 != woken) {
+        printf("task didn't block\n");
+        return false;
+    }
+
+    WAKE(tid);
+    run(5);
+
+    if(1 != woken) {
+        printf("task didn't wake\n");
+        return false;
+    }
+
+    // let it time out
+    tick = 5;
+    run(5);
+
+    if(2 != woken || RET_TIMEOUT != block_ret || task.running()) {
+        printf("task didn't time out\n");
+        return false;
+    }
+
+    return true;
+}
+
+static WaitQueue queue;
+static int num_waited = 0;
+
+Coro waiter(void*) {
+    // a macro function blocking a coroutine task
+    RetType ret = co_await coro::call([] { return queue.wait(); });
+
+    if(RET_SUCCESS == ret) {
+        num_waited++;
+    }
+
+    co_return ret;
+}
+
+bool macro_test() {
+    alloc::CoroTask<256> tasks[NUM_TASKS];
+    num_waited = 0;
+
+    for(int i = 0; i < NUM_TASKS; i++) {
+        if(-1 == tasks[i].start(&waiter, NULL)) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    run(NUM_TASKS);
+
+    if(NUM_TASKS != queue.size()) {
+        printf("expected %i waiters, there are %lu\n", NUM_TASKS, queue.size());
+        return false;
+    }
+
+    queue.wake_all();
+    run(NUM_TASKS * 2);
+
+    if(NUM_TASKS != num_waited) {
+        printf("only %i of %i waiters woke\n", num_waited, NUM_TASKS);
+        return false;
+    }
+
+    return true;
+}
+
+static int depth = 0;
+
+// recurses until it runs out of arena
+Coro recurse(int n) {
+    depth = n;
+    RetType ret = co_await recurse(n + 1);
+    co_return ret;
+}
+
+Coro deep(void*) {
+    co_return co_await recurse(0);
+}
+
+bool arena_test() {
+    alloc::CoroTask<1024> task;
+
+    task.start(&deep, NULL);
+    run(5);
+
+    if(task.running() || RET_ERROR != task.result()) {
+        printf("running out of arena didn't fail\n");
+        return false;
+    }
+
+    if(depth == 0 || task.arena().high_water() > task.arena().size()) {
+        printf("bad arena use: depth %i, %lu bytes\n", depth, task.arena().high_water());
+        return false;
+    }
+
+    // frames are freed, so it can be run again
+    int first = depth;
+    task.start(&deep, NULL);
+    run(5);
+
+    if(depth != first) {
+        printf("frames weren't freed, recursed %i then %i deep\n", first, depth);
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(reentrant_test()) {
+        printf("passed reentrant test\n");
+    } else {
+        printf("failed reentrant test\n");
+    }
+
+    if(block_test()) {
+        printf("passed block test\n");
+    } else {
+        printf("failed block test\n");
+    }
+
+    if(macro_test()) {
+        printf("passed macro call test\n");
+    } else {
+        printf("failed macro call test\n");
+    }
+
+    if(arena_test()) {
+        printf("passed arena test\n");
+    } else {
+        printf("failed arena test\n");
+    }
+}
@@ -0,0 +1,68 @@
+// tests the scheduler sleeps the process when no task is ready instead of
+// spinning, by comparing CPU time to wall time
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "sched/macros.h"
+#include "sched/platforms/linux/LinuxIdle.h"
+
+static const int NUM_SLEEPS = 20;
+static const uint32_t SLEEP_TICKS = 10;
+
+static int num_woke = 0;
+static uint32_t max_late = 0;
+
+RetType sleeper(void*) {
+    RESUME();
+
+    static uint32_t wake_time;
+
+    while(num_woke < NUM_SLEEPS) {
+        wake_time = sched_time() + SLEEP_TICKS;
+        SLEEP(SLEEP_TICKS);
+
+        if(sched_time() - wake_time > max_late) {
+            max_late = sched_time() - wake_time;
+        }
+
+        num_woke++;
+    }
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+int main() {
+    // 1 ms ticks
+    if(!linux_sched_init(1000000)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(sched_start(&sleeper, NULL) < 0) {
+        printf("failed to start task\n");
+        return -1;
+    }
+
+    clock_t cpu_start = clock();
+    uint32_t start = sched_time();
+
+    while(num_woke < NUM_SLEEPS) {
+        sched_dispatch();
+    }
+
+    double cpu_ms = 1000.0 * (clock() - cpu_start) / CLOCKS_PER_SEC;
+    uint32_t wall_ms = sched_time() - start;
+
+    printf("%u ms wall, %.2f ms CPU, woke at most %u ms late\n", wall_ms, cpu_ms, max_late);
+
+    // the process should have been asleep for almost all of the time
+    // lateness is only reported, it depends on how loaded the host is
+    if(cpu_ms < wall_ms / 10.0) {
+        printf("passed idle test\n");
+    } else {
+        printf("failed idle test\n");
+    }
+}
@@ -0,0 +1,262 @@
+// tests tasks woken with 'sched_wake_isr' from outside the scheduler, other
+// threads and a signal handler standing in for interrupts
+//
+// build: g++ -pthread -I../.. ../sched.cpp isr_wake_test.cpp -o isr_wake_test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "sched/macros.h"
+#include "sched/platforms/linux/LinuxIdle.h"
+
+static const int NUM_THREAD_WAKES = 10000;
+static const int NUM_SIGNAL_WAKES = 50;
+
+static volatile int num_woke = 0;
+static int target = 0;
+
+// set by the task right before it blocks, the producer only wakes it then
+static volatile bool armed = false;
+
+// tells the producer thread to give up
+static volatile bool stop = false;
+
+static tid_t waiter_tid;
+
+RetType waiter(void*) {
+    RESUME();
+
+    while(num_woke < target) {
+        __atomic_store_n(&armed, true, __ATOMIC_RELEASE);
+
+        // the producer may wake us before we've even blocked, the wake is
+        // queued and we're woken on the next dispatch instead of it being lost
+        BLOCK();
+
+        num_woke++;
+    }
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+void* producer(void*) {
+    for(int i = 0; i < NUM_THREAD_WAKES; i++) {
+        while(!__atomic_exchange_n(&armed, false, __ATOMIC_ACQ_REL)) {
+            // wait for the task to block again
+            if(stop) {
+                return NULL;
+            }
+
+            // let the scheduler thread run if there's only one CPU
+            sched_yield();
+        }
+
+        WAKE_ISR(waiter_tid);
+    }
+
+    return NULL;
+}
+
+bool thread_test() {
+    num_woke = 0;
+    target = NUM_THREAD_WAKES;
+    armed = false;
+
+    waiter_tid = sched_start(&waiter, NULL);
+    if(waiter_tid < 0) {
+        printf("failed to start task\n");
+        return false;
+    }
+
+    pthread_t thread;
+    if(0 != pthread_create(&thread, NULL, &producer, NULL)) {
+        printf("failed to start thread\n");
+        return false;
+    }
+
+    uint32_t start = sched_time();
+    while(num_woke < NUM_THREAD_WAKES && sched_time() - start < 10000) {
+        sched_dispatch();
+        sched_yield();
+    }
+
+    stop = true;
+    pthread_join(thread, NULL);
+
+    if(num_woke != NUM_THREAD_WAKES) {
+        printf("task woke %i times, expected %i\n", num_woke, NUM_THREAD_WAKES);
+        return false;
+    }
+
+    printf("%i wakes from a thread in %u ms\n", num_woke, sched_time() - start);
+    return true;
+}
+
+static const int NUM_PRODUCERS = 4;
+
+struct multi_t {
+    tid_t tid;
+    volatile bool armed;
+    volatile int num_woke;
+};
+
+static multi_t multi[NUM_PRODUCERS];
+
+RetType multi_waiter(void* arg) {
+    multi_t* m = (multi_t*)arg;
+
+    RESUME();
+
+    while(m->num_woke < NUM_THREAD_WAKES) {
+        __atomic_store_n(&(m->armed), true, __ATOMIC_RELEASE);
+        BLOCK();
+        m->num_woke++;
+    }
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+void* multi_producer(void* arg) {
+    multi_t* m = (multi_t*)arg;
+
+    for(int i = 0; i < NUM_THREAD_WAKES; i++) {
+        while(!__atomic_exchange_n(&(m->armed), false, __ATOMIC_ACQ_REL)) {
+            if(stop) {
+                return NULL;
+            }
+
+            sched_yield();
+        }
+
+        WAKE_ISR(m->tid);
+    }
+
+    return NULL;
+}
+
+// every producer wakes its own task, all pushing onto the ring at once
+bool multi_test() {
+    stop = false;
+
+    for(int i = 0; i < NUM_PRODUCERS; i++) {
+        multi[i].armed = false;
+        multi[i].num_woke = 0;
+        multi[i].tid = sched_start(&multi_waiter, &(multi[i]));
+
+        if(multi[i].tid < 0) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    pthread_t threads[NUM_PRODUCERS];
+    for(int i = 0; i < NUM_PRODUCERS; i++) {
+        if(0 != pthread_create(&(threads[i]), NULL, &multi_producer, &(multi[i]))) {
+            printf("failed to start thread\n");
+            return false;
+        }
+    }
+
+    uint32_t start = sched_time();
+    int total = 0;
+    while(total < NUM_PRODUCERS * NUM_THREAD_WAKES && sched_time() - start < 20000) {
+        sched_dispatch();
+        sched_yield();
+
+        total = 0;
+        for(int i = 0; i < NUM_PRODUCERS; i++) {
+            total += multi[i].num_woke;
+        }
+    }
+
+    stop = true;
+    for(int i = 0; i < NUM_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if(total != NUM_PRODUCERS * NUM_THREAD_WAKES) {
+        printf("tasks woke %i times, expected %i\n", total,
+               NUM_PRODUCERS * NUM_THREAD_WAKES);
+        return false;
+    }
+
+    printf("%i wakes from %i threads in %u ms\n", total, NUM_PRODUCERS,
+           sched_time() - start);
+    return true;
+}
+
+void alarm_handler(int) {
+    WAKE_ISR(waiter_tid);
+}
+
+bool signal_test() {
+    num_woke = 0;
+    target = NUM_SIGNAL_WAKES;
+
+    waiter_tid = sched_start(&waiter, NULL);
+    if(waiter_tid < 0) {
+        printf("failed to start task\n");
+        return false;
+    }
+
+    struct sigaction sa = {};
+    sa.sa_handler = &alarm_handler;
+    sigaction(SIGALRM, &sa, NULL);
+
+    // 'interrupt' every millisecond
+    struct itimerval timer = {{0, 1000}, {0, 1000}};
+    setitimer(ITIMER_REAL, &timer, NULL);
+
+    uint32_t start = sched_time();
+    while(num_woke < NUM_SIGNAL_WAKES && sched_time() - start < 5000) {
+        // sleeps in the idle function until the signal arrives
+        sched_dispatch();
+    }
+
+    struct itimerval stop = {};
+    setitimer(ITIMER_REAL, &stop, NULL);
+
+    if(num_woke != NUM_SIGNAL_WAKES) {
+        printf("task woke %i times, expected %i\n", num_woke, NUM_SIGNAL_WAKES);
+        return false;
+    }
+
+    printf("%i wakes from a signal handler in %u ms\n", num_woke, sched_time() - start);
+    return true;
+}
+
+int main() {
+    if(!linux_sched_init(1000000)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    // spin for the thread test, the thread doesn't interrupt the idle sleep
+    sched_idle(NULL);
+
+    if(thread_test()) {
+        printf("passed thread wake test\n");
+    } else {
+        printf("failed thread wake test\n");
+    }
+
+    if(multi_test()) {
+        printf("passed multi producer test\n");
+    } else {
+        printf("failed multi producer test\n");
+    }
+
+    sched_idle(&linux_sched_idle);
+
+    if(signal_test()) {
+        printf("passed signal wake test\n");
+    } else {
+        printf("failed signal wake test\n");
+    }
+}
@@ -0,0 +1,198 @@
+// tests periodic tasks are released at a fixed rate and keep deadline and
+// jitter statistics
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+// how long each job takes, in ticks
+static uint32_t job_time = 0;
+
+// start time of each job
+static uint32_t starts[16];
+static int num_starts = 0;
+
+// order jobs were run in, by task argument
+static int order[16];
+static int num_order = 0;
+
+RetType job(void*) {
+    if(num_starts == 16) {
+        return RET_ERROR;
+    }
+
+    starts[num_starts++] = tick;
+
+    // simulate the job taking some time
+    tick += job_time;
+
+    return RET_SUCCESS;
+}
+
+RetType tagged(void* arg) {
+    if(num_order == 16) {
+        return RET_ERROR;
+    }
+
+    order[num_order++] = *(int*)arg;
+    return RET_SUCCESS;
+}
+
+// run the scheduler until all tasks exit
+void run_all(uint32_t ticks) {
+    for(uint32_t t = 0; t < ticks; t++) {
+        for(int i = 0; i < 4; i++) {
+            sched_dispatch();
+        }
+        tick++;
+    }
+}
+
+bool fixed_rate() {
+    tick = 100;
+    num_starts = 0;
+    job_time = 3;
+
+    tid_t tid = sched_start_periodic(&job, NULL, 10, 5);
+    if(tid < 0) {
+        printf("failed to start periodic task\n");
+        return false;
+    }
+
+    run_all(200);
+
+    for(int i = 0; i < 16; i++) {
+        if(starts[i] != 100 + 10 * (uint32_t)i) {
+            printf("job %i started at %u, expected %u\n", i, starts[i], 100 + 10 * i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool deadlines() {
+    tick = 0;
+    num_starts = 0;
+    job_time = 4;
+
+    tid_t tid = sched_start_periodic(&job, NULL, 10, 2);
+    if(tid < 0) {
+        printf("failed to start periodic task\n");
+        return false;
+    }
+
+    // stats are gone once the task exits, so check before the last job
+    for(int t = 0; t < 50; t++) {
+        sched_dispatch();
+        tick++;
+    }
+
+    const periodic_stats_t* stats = sched_periodic_stats(tid);
+    if(NULL == stats) {
+        printf("no stats for periodic task\n");
+        return false;
+    }
+
+    if(stats->misses != stats->jobs) {
+        printf("%u of %u jobs missed their deadline, expected all\n", stats->misses, stats->jobs);
+        return false;
+    }
+
+    run_all(200);
+    return true;
+}
+
+bool overrun() {
+    tick = 0;
+    num_starts = 0;
+    job_time = 25;
+
+    tid_t tid = sched_start_periodic(&job, NULL, 10);
+    if(tid < 0) {
+        printf("failed to start periodic task\n");
+        return false;
+    }
+
+    // first job runs from 0 to 25, the release at 10 is dropped and the
+    // release at 20 runs late from 25 to 50, dropping 30 and 40
+    sched_dispatch();
+    sched_dispatch();
+
+    const periodic_stats_t* stats = sched_periodic_stats(tid);
+    if(stats->skipped != 1 + 2) {
+        printf("skipped %u releases, expected 3\n", stats->skipped);
+        return false;
+    }
+
+    if(stats->max_jitter != 5) {
+        printf("max jitter of %u, expected 5\n", stats->max_jitter);
+        return false;
+    }
+
+    job_time = 0;
+    run_all(400);
+    return true;
+}
+
+bool edf() {
+    static int args[3] = {0, 1, 2};
+
+    tick = 0;
+    num_order = 0;
+
+    // a high priority FIFO task should run after EDF tasks
+    sched_start(&tagged, &args[0], 0);
+    sched_start_periodic(&tagged, &args[1], 100, 50, SCHED_DEFAULT_PRIORITY, true);
+    sched_start_periodic(&tagged, &args[2], 100, 20, SCHED_DEFAULT_PRIORITY, true);
+
+    sched_dispatch();
+    sched_dispatch();
+    sched_dispatch();
+
+    if(order[0] != 2 || order[1] != 1 || order[2] != 0) {
+        printf("ran in order %i %i %i, expected 2 1 0\n", order[0], order[1], order[2]);
+        return false;
+    }
+
+    num_order = 16;
+    run_all(400);
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(fixed_rate()) {
+        printf("passed fixed rate test\n");
+    } else {
+        printf("failed fixed rate test\n");
+    }
+
+    if(deadlines()) {
+        printf("passed deadline test\n");
+    } else {
+        printf("failed deadline test\n");
+    }
+
+    if(overrun()) {
+        printf("passed overrun test\n");
+    } else {
+        printf("failed overrun test\n");
+    }
+
+    if(edf()) {
+        printf("passed EDF test\n");
+    } else {
+        printf("failed EDF test\n");
+    }
+}
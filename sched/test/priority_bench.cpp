@@ -0,0 +1,138 @@
+// benchmarks dispatch latency of a control task woken while bulk tasks are
+// ready, with the control task at the same priority and at a higher priority
+//
+// build: g++ -O2 -I../.. ../sched.cpp priority_bench.cpp -o priority_bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "sched/macros.h"
+
+static const int NUM_WAKES = 10000;
+static const int BULK_WORK = 200;
+
+uint32_t systime() {
+    return 0;
+}
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+// time and dispatch count when the control task was last woken
+static uint64_t wake_ns;
+static uint64_t wake_dispatch;
+static uint64_t dispatches;
+static bool pending;
+
+// set to make all tasks exit
+static bool stop;
+
+// latency results
+static uint64_t total_ns;
+static uint64_t max_ns;
+static uint64_t total_dispatches;
+static int woken;
+
+// bulk work, always ready
+RetType bulk(void*) {
+    if(stop) {
+        return RET_ERROR;
+    }
+
+    for(int i = 0; i < BULK_WORK; i++) {
+        sink = sink + i;
+    }
+
+    return RET_SUCCESS;
+}
+
+// control task, blocks until woken
+RetType control(void*) {
+    RESUME();
+
+    while(1) {
+        BLOCK();
+
+        if(stop) {
+            RESET();
+            return RET_ERROR;
+        }
+
+        uint64_t lat = now_ns() - wake_ns;
+        total_ns += lat;
+        if(lat > max_ns) {
+            max_ns = lat;
+        }
+        total_dispatches += dispatches - wake_dispatch;
+        woken++;
+        pending = false;
+    }
+}
+
+void run(int num_bulk, uint8_t control_priority) {
+    total_ns = 0;
+    max_ns = 0;
+    total_dispatches = 0;
+    woken = 0;
+    dispatches = 0;
+    pending = false;
+    stop = false;
+
+    tid_t ctl = sched_start(&control, NULL, control_priority);
+    for(int i = 0; i < num_bulk; i++) {
+        sched_start(&bulk, NULL);
+    }
+
+    // let the control task block
+    for(int i = 0; i <= num_bulk; i++) {
+        sched_dispatch();
+    }
+
+    while(woken < NUM_WAKES) {
+        if(!pending && (dispatches % 7) == 0) {
+            // simulate an ISR waking the control task
+            pending = true;
+            wake_ns = now_ns();
+            wake_dispatch = dispatches;
+            WAKE(ctl);
+        }
+
+        sched_dispatch();
+        dispatches++;
+    }
+
+    printf("%2i bulk tasks, control priority %2u: mean %6.2f dispatches, mean %8.0f ns, max %8lu ns\n",
+           num_bulk, control_priority,
+           (double)total_dispatches / woken,
+           (double)total_ns / woken,
+           (unsigned long)max_ns);
+
+    // let every task exit
+    stop = true;
+    WAKE(ctl);
+    for(int i = 0; i <= num_bulk; i++) {
+        sched_dispatch();
+    }
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    const int num_bulk[] = {1, 15, 63};
+    for(size_t i = 0; i < sizeof(num_bulk) / sizeof(num_bulk[0]); i++) {
+        // same priority as the bulk tasks, round robin
+        run(num_bulk[i], SCHED_DEFAULT_PRIORITY);
+
+        // higher priority than the bulk tasks
+        run(num_bulk[i], 0);
+    }
+}
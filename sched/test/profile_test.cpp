@@ -0,0 +1,116 @@
+// tests the task profiler and dispatch trace
+//
+// build: g++ -DSCHED_PROFILE -I../.. ../sched.cpp profile_test.cpp -o profile_test
+// view the trace: ../trace/trace2json profile_trace.bin profile_trace.json
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+#include "sched/trace/trace.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+// profiling clock, counts 10 cycles per tick
+uint32_t cycles = 0;
+uint32_t cyclecount() {
+    return cycles;
+}
+
+RetType sleeper(void*) {
+    RESUME();
+
+    // take 5 cycles then sleep
+    cycles += 5;
+    SLEEP(1);
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+RetType yielder(void*) {
+    RESUME();
+
+    // take 2 cycles then yield
+    cycles += 2;
+    YIELD();
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+RetType blocker(void*) {
+    RESUME();
+
+    // take 30 cycles then block forever
+    cycles += 30;
+    BLOCK();
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(!sched_profile_clock(&cyclecount)) {
+        printf("failed to set profiling clock\n");
+        return -1;
+    }
+
+    if(!sched_trace_open("profile_trace.bin", 10)) {
+        printf("failed to open trace file\n");
+        return -1;
+    }
+
+    tid_t sleep_tid = sched_start(&sleeper, NULL);
+    tid_t yield_tid = sched_start(&yielder, NULL);
+    tid_t block_tid = sched_start(&blocker, NULL);
+
+    for(int i = 0; i < 100; i++) {
+        sched_dispatch();
+        sched_dispatch();
+        sched_dispatch();
+        tick++;
+        cycles += 10;
+    }
+
+    sched_trace_close();
+
+    const task_profile_t* prof = sched_profile(sleep_tid);
+    bool pass = true;
+
+    // sleeps every other dispatch
+    if(prof->sleeps != prof->dispatches / 2 || prof->total_time != prof->sleeps * 5 || prof->max_time != 5) {
+        printf("bad sleeper profile: %u sleeps, total %lu, max %u\n",
+               prof->sleeps, (unsigned long)prof->total_time, prof->max_time);
+        pass = false;
+    }
+
+    prof = sched_profile(yield_tid);
+    // yields every other dispatch
+    if(prof->yields != (prof->dispatches + 1) / 2 || prof->total_time != prof->yields * 2) {
+        printf("bad yielder profile: %u dispatches, %u yields, total %lu\n",
+               prof->dispatches, prof->yields, (unsigned long)prof->total_time);
+        pass = false;
+    }
+
+    prof = sched_profile(block_tid);
+    if(prof->dispatches != 1 || prof->blocks != 1 || prof->max_time != 30) {
+        printf("bad blocker profile: %u dispatches, %u blocks, max %u\n",
+               prof->dispatches, prof->blocks, prof->max_time);
+        pass = false;
+    }
+
+    if(pass) {
+        printf("passed profile test\n");
+    } else {
+        printf("failed profile test\n");
+    }
+}
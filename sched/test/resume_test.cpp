@@ -0,0 +1,139 @@
+// tests the RESUME/CALL macros keep separate execution points per task
+// when several tasks are suspended in the same nested functions
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+static int count[MAX_NUM_TASKS];
+static int finished[MAX_NUM_TASKS];
+
+// innermost function, suspends twice
+RetType inner(void) {
+    RESUME();
+
+    count[sched_dispatched]++;
+    SLEEP(1);
+
+    count[sched_dispatched]++;
+    YIELD();
+
+    count[sched_dispatched]++;
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+// middle function, CALLs 'inner' twice
+RetType middle(void) {
+    RESUME();
+
+    CALL(inner());
+    CALL(inner());
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+// recurses 'depth' functions deep, used to check the nesting limit
+RetType deep(int depth) {
+    RESUME();
+
+    RetType ret = RET_SUCCESS;
+    if(depth > 0) {
+        ret = CALL(deep(depth - 1));
+    }
+
+    RESET();
+    return ret;
+}
+
+RetType task(void*) {
+    RESUME();
+
+    CALL(middle());
+    finished[sched_dispatched]++;
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+bool nested() {
+    static const int NUM = 8;
+
+    for(int i = 0; i < NUM; i++) {
+        if(sched_start(&task, NULL) < 0) {
+            printf("failed to start task %i\n", i);
+            return false;
+        }
+    }
+
+    for(int i = 0; i < 100; i++) {
+        sched_dispatch();
+        tick++;
+    }
+
+    for(int i = 0; i < NUM; i++) {
+        if(count[i] != 6) {
+            printf("task %i executed inner %i times, expected 6\n", i, count[i]);
+            return false;
+        }
+
+        if(finished[i] != 1) {
+            printf("task %i finished %i times, expected 1\n", i, finished[i]);
+            return false;
+        }
+    }
+
+    if(sched_dispatched_task->depth != 0) {
+        printf("system continuation stack not empty\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool too_deep() {
+    // called outside of a task, uses the system continuation stack
+    if(RET_SUCCESS != deep(SCHED_RESUME_DEPTH - 1)) {
+        printf("failed to nest %i functions\n", SCHED_RESUME_DEPTH);
+        return false;
+    }
+
+    if(RET_ERROR != deep(SCHED_RESUME_DEPTH)) {
+        printf("allowed nesting past SCHED_RESUME_DEPTH\n");
+        return false;
+    }
+
+    if(sched_dispatched_task->depth != 0) {
+        printf("continuation stack not unwound\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(nested()) {
+        printf("passed nested test\n");
+    } else {
+        printf("failed nested test\n");
+    }
+
+    if(too_deep()) {
+        printf("passed depth limit test\n");
+    } else {
+        printf("failed depth limit test\n");
+    }
+}
@@ -0,0 +1,284 @@
+// tests the work-stealing deque and the multi-threaded runtime: many nodes
+// replayed on several workers give the same results as on one, and tasks on
+// different nodes can wake each other
+//
+// build: g++ -O2 -pthread -I../.. ../sched.cpp runtime_test.cpp -o runtime_test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "sched/macros.h"
+#include "sched/platforms/linux/LinuxIdle.h"
+#include "sched/platforms/linux/LinuxRuntime.h"
+
+static const int NUM_ITEMS = 200000;
+static const int NUM_THIEVES = 3;
+
+static alloc::WorkDeque<int, 256> deque;
+static int items[NUM_ITEMS];
+static volatile int taken[NUM_ITEMS];
+static volatile bool owner_done = false;
+
+void take(int* item) {
+    __atomic_add_fetch(&(taken[item - items]), 1, __ATOMIC_RELAXED);
+}
+
+void* thief(void*) {
+    while(1) {
+        bool done = __atomic_load_n(&owner_done, __ATOMIC_ACQUIRE);
+
+        int* item = deque.steal();
+        if(item) {
+            take(item);
+        } else if(done && 0 == deque.size()) {
+            return NULL;
+        }
+    }
+}
+
+// owner pushes every item and pops some, thieves steal the rest
+// every item should be taken exactly once
+bool deque_test() {
+    pthread_t thieves[NUM_THIEVES];
+
+    for(int i = 0; i < NUM_THIEVES; i++) {
+        pthread_create(&(thieves[i]), NULL, &thief, NULL);
+    }
+
+    for(int i = 0; i < NUM_ITEMS; i++) {
+        items[i] = i;
+
+        while(!deque.push(&(items[i]))) {
+            // full, take one back
+            int* item = deque.pop();
+            if(item) {
+                take(item);
+            }
+        }
+
+        if(0 == i % 3) {
+            int* item = deque.pop();
+            if(item) {
+                take(item);
+            }
+        }
+    }
+
+    __atomic_store_n(&owner_done, true, __ATOMIC_RELEASE);
+
+    for(int i = 0; i < NUM_THIEVES; i++) {
+        pthread_join(thieves[i], NULL);
+    }
+
+    for(int i = 0; i < NUM_ITEMS; i++) {
+        if(1 != taken[i]) {
+            printf("item %i taken %i times\n", i, taken[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static const size_t NUM_NODES = 16;
+static const int TASKS_PER_NODE = 4;
+static const int NUM_JOBS = 100;
+static const int JOB_WORK = 20000;
+
+// stands in for one simulated flight computer
+typedef struct {
+    alloc::Scheduler<8> sched;
+    uint32_t results[TASKS_PER_NODE];
+    int index;
+} node_t;
+
+static node_t nodes[NUM_NODES];
+
+// number crunching task, yields between jobs
+RetType cruncher(void* arg) {
+    // tasks on different nodes run at the same time, so nothing kept across
+    // a yield can be static, this is set again every dispatch
+    uint32_t* result = (uint32_t*)arg;
+
+    RESUME();
+
+    // low bits are the job count, high bits a checksum of the work
+    while((*result & 0xFFFF) < NUM_JOBS) {
+        uint32_t x = *result + 1;
+        for(int i = 0; i < JOB_WORK; i++) {
+            x = x * 1664525U + 1013904223U;
+        }
+
+        *result = ((*result & 0xFFFF) + 1) | (((*result >> 16) ^ (x >> 16)) << 16);
+        YIELD();
+    }
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+// sleeps a few ticks of the node's clock, exits
+RetType napper(void*) {
+    RESUME();
+
+    SLEEP(1);
+    SLEEP(1);
+
+    RESET();
+    return RET_ERROR;
+}
+
+void setup_nodes() {
+    for(size_t n = 0; n < NUM_NODES; n++) {
+        nodes[n].sched.init(&linux_sched_time);
+
+        for(int t = 0; t < TASKS_PER_NODE; t++) {
+            nodes[n].results[t] = 0;
+            nodes[n].sched.start(&cruncher, &(nodes[n].results[t]));
+        }
+
+        nodes[n].sched.start(&napper, NULL);
+    }
+}
+
+// replay every node and return the wall time in ms, 0 on failure
+double replay(size_t workers, uint32_t* checksum) {
+    alloc::LinuxRuntime<NUM_NODES> runtime;
+    alloc::LinuxRuntime<NUM_NODES>* rt = &runtime;
+
+    setup_nodes();
+    for(size_t n = 0; n < NUM_NODES; n++) {
+        rt->add(&(nodes[n].sched));
+    }
+
+    uint64_t start = _linux_sched_ns();
+    if(!rt->run(workers)) {
+        return 0;
+    }
+    double ms = (_linux_sched_ns() - start) / 1000000.0;
+
+    *checksum = 0;
+    for(size_t n = 0; n < NUM_NODES; n++) {
+        for(int t = 0; t < TASKS_PER_NODE; t++) {
+            if((nodes[n].results[t] & 0xFFFF) != NUM_JOBS) {
+                printf("node %lu task %i only ran %u jobs\n", n, t, nodes[n].results[t] & 0xFFFF);
+                return 0;
+            }
+
+            *checksum ^= nodes[n].results[t] + n * 31 + t;
+        }
+    }
+
+    uint64_t steals = 0;
+    for(size_t w = 0; w < workers; w++) {
+        steals += rt->steals(w);
+    }
+
+    printf("%lu nodes on %lu workers: %.1f ms, %lu steals\n", NUM_NODES, workers, ms, steals);
+    return ms;
+}
+
+bool replay_test() {
+    uint32_t one, many;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t workers = (cpus < 4) ? 4 : (cpus > 16 ? 16 : cpus);
+
+    double one_ms = replay(1, &one);
+    double many_ms = replay(workers, &many);
+
+    if(0 == one_ms || 0 == many_ms) {
+        return false;
+    }
+
+    if(one != many) {
+        printf("results differ between 1 and %lu workers\n", workers);
+        return false;
+    }
+
+    printf("speedup %.2fx on %ld cpus\n", one_ms / many_ms, cpus);
+    return true;
+}
+
+static const int NUM_PINGS = 2000;
+
+static alloc::LinuxRuntime<2> pp_runtime;
+static alloc::Scheduler<2> pp_scheds[2];
+static int pp_nodes[2];
+static tid_t pp_tids[2];
+static int pp_count[2];
+
+// check if it's a task's turn, task 0 goes first then they take turns
+static bool my_turn(int me) {
+    int mine = __atomic_load_n(&(pp_count[me]), __ATOMIC_ACQUIRE);
+    int theirs = __atomic_load_n(&(pp_count[1 - me]), __ATOMIC_ACQUIRE);
+
+    return (0 == me) ? (mine == theirs) : (mine < theirs);
+}
+
+// waits for it's turn, counts, and wakes the task on the other node
+RetType pinger(void* arg) {
+    int me = (int)(size_t)arg;
+
+    RESUME();
+
+    while(pp_count[me] < NUM_PINGS) {
+        // check before blocking, a wake sent before we block is lost
+        while(!my_turn(me)) {
+            BLOCK();
+        }
+
+        __atomic_add_fetch(&(pp_count[me]), 1, __ATOMIC_ACQ_REL);
+        pp_runtime.wake(pp_nodes[1 - me], pp_tids[1 - me]);
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+bool ping_test() {
+    for(int i = 0; i < 2; i++) {
+        pp_scheds[i].init(&linux_sched_time);
+        pp_count[i] = 0;
+    }
+
+    pp_tids[1] = pp_scheds[1].start(&pinger, (void*)1);
+    pp_tids[0] = pp_scheds[0].start(&pinger, (void*)0);
+    pp_nodes[0] = pp_runtime.add(&(pp_scheds[0]));
+    pp_nodes[1] = pp_runtime.add(&(pp_scheds[1]));
+
+    uint64_t start = _linux_sched_ns();
+    pp_runtime.run(2);
+    double ms = (_linux_sched_ns() - start) / 1000000.0;
+
+    if(pp_count[0] != NUM_PINGS || pp_count[1] != NUM_PINGS) {
+        printf("only %i and %i pings\n", pp_count[0], pp_count[1]);
+        return false;
+    }
+
+    printf("%i cross-node wakes in %.1f ms\n", 2 * NUM_PINGS, ms);
+    return true;
+}
+
+int main() {
+    linux_sched_init(1000000);
+
+    if(deque_test()) {
+        printf("passed deque test\n");
+    } else {
+        printf("failed deque test\n");
+    }
+
+    if(replay_test()) {
+        printf("passed replay test\n");
+    } else {
+        printf("failed replay test\n");
+    }
+
+    if(ping_test()) {
+        printf("passed ping test\n");
+    } else {
+        printf("failed ping test\n");
+    }
+}
@@ -0,0 +1,288 @@
+// scheduler microbenchmarks, run with 1, 16, and 64 tasks
+//  dispatch    - tasks that are always ready, cost of one dispatch
+//  sleep       - how late a task runs after it's SLEEP expires
+//  block_wake  - a task WAKEs each blocked task, cost of one WAKE, dispatch,
+//                and BLOCK round trip
+//  call_depth  - tasks YIELD from CALLs nested 'depth' deep, cost of one
+//                dispatch back down to where the task yielded
+//
+// results are printed as JSON so they can be saved and compared across commits
+//  ./sched_bench > bench.json
+//
+// build: g++ -O2 -I../.. ../sched.cpp sched_bench.cpp -o sched_bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "sched/macros.h"
+#include "sched/Scheduler.h"
+
+static const int TASK_COUNTS[] = {1, 16, 64};
+static const int NUM_DISPATCHES = 2000000;
+static const int NUM_SLEEPS = 50000;
+static const int NUM_ROUND_TRIPS = 1000000;
+static const int CALL_DEPTHS[] = {1, 4, 8, 15};
+
+// sleep length, in ticks (ns)
+static const uint32_t SLEEP_TICKS = 20000;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// one tick is one ns, wraps every ~4s which the scheduler handles
+uint32_t ns_time() {
+    return (uint32_t)now_ns();
+}
+
+// room for the most tasks plus a waker
+static alloc::Scheduler<80> sched;
+
+// set to make all tasks exit
+static bool stop;
+
+static volatile uint32_t sink;
+
+static bool first_result = true;
+
+// print one result as a JSON object
+void result(const char* name, int tasks, int depth, uint64_t ops, uint64_t ns,
+            double mean_lat, uint64_t max_lat) {
+    printf("%s\n    {\"name\": \"%s\", \"tasks\": %i", first_result ? "" : ",", name, tasks);
+    first_result = false;
+
+    if(depth > 0) {
+        printf(", \"depth\": %i", depth);
+    }
+
+    printf(", \"ops\": %lu, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f",
+           ops, (double)ns / ops, ops * 1e9 / ns);
+
+    if(mean_lat >= 0) {
+        printf(", \"mean_latency_ns\": %.1f, \"max_latency_ns\": %lu", mean_lat, max_lat);
+    }
+
+    printf("}");
+}
+
+// dispatch until every task has exited
+void drain() {
+    while(sched.free_tasks() != sched.max_tasks()) {
+        sched.dispatch();
+    }
+}
+
+// always ready
+RetType spinner(void*) {
+    if(stop) {
+        return RET_ERROR;
+    }
+
+    sink = sink + 1;
+    return RET_SUCCESS;
+}
+
+void dispatch_bench(int tasks) {
+    stop = false;
+    for(int i = 0; i < tasks; i++) {
+        sched.start(&spinner, NULL);
+    }
+
+    uint64_t start = now_ns();
+    for(int i = 0; i < NUM_DISPATCHES; i++) {
+        sched.dispatch();
+    }
+    uint64_t ns = now_ns() - start;
+
+    stop = true;
+    drain();
+
+    result("dispatch", tasks, 0, NUM_DISPATCHES, ns, -1, 0);
+}
+
+static uint64_t sleeps;
+static uint64_t total_lat;
+static uint64_t max_lat;
+
+// sleeps, measures how late it woke up
+RetType sleeper(void* arg) {
+    // stagger the tasks so they don't all wake together
+    uint32_t offset = (uint32_t)(size_t)arg;
+
+    RESUME();
+
+    SLEEP(SLEEP_TICKS + offset);
+
+    while(!stop) {
+        {
+            uint32_t lat = sched_time() - sched_dispatched_task->wake_time;
+            total_lat += lat;
+            if(lat > max_lat) {
+                max_lat = lat;
+            }
+
+            if(++sleeps >= NUM_SLEEPS) {
+                stop = true;
+            }
+        }
+
+        SLEEP(SLEEP_TICKS + offset);
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+void sleep_bench(int tasks) {
+    stop = false;
+    sleeps = 0;
+    total_lat = 0;
+    max_lat = 0;
+
+    for(int i = 0; i < tasks; i++) {
+        sched.start(&sleeper, (void*)(size_t)(i * 97));
+    }
+
+    uint64_t start = now_ns();
+    drain();
+    uint64_t ns = now_ns() - start;
+
+    result("sleep", tasks, 0, sleeps, ns, (double)total_lat / sleeps, max_lat);
+}
+
+static tid_t blocked_tids[80];
+static int num_blocked;
+static uint64_t round_trips;
+
+// blocks until woken
+RetType blocker(void*) {
+    RESUME();
+
+    BLOCK();
+
+    while(!stop) {
+        round_trips++;
+        BLOCK();
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+// wakes every blocked task, lets them run
+RetType waker(void*) {
+    static int i;
+
+    RESUME();
+
+    while(round_trips < NUM_ROUND_TRIPS) {
+        for(i = 0; i < num_blocked; i++) {
+            WAKE(blocked_tids[i]);
+        }
+
+        YIELD();
+    }
+
+    stop = true;
+    for(i = 0; i < num_blocked; i++) {
+        WAKE(blocked_tids[i]);
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+void block_wake_bench(int tasks) {
+    stop = false;
+    round_trips = 0;
+    num_blocked = tasks;
+
+    for(int i = 0; i < tasks; i++) {
+        blocked_tids[i] = sched.start(&blocker, NULL);
+    }
+
+    // get every task blocked before timing
+    for(int i = 0; i < tasks; i++) {
+        sched.dispatch();
+    }
+
+    sched.start(&waker, NULL);
+
+    uint64_t start = now_ns();
+    drain();
+    uint64_t ns = now_ns() - start;
+
+    result("block_wake", tasks, 0, round_trips, ns, -1, 0);
+}
+
+static int call_depth;
+
+// calls itself 'depth' deep, then yields
+RetType nested(int depth) {
+    RESUME();
+
+    if(depth > 1) {
+        CALL(nested(depth - 1));
+    } else {
+        sink = sink + 1;
+        YIELD();
+    }
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+RetType caller(void*) {
+    RESUME();
+
+    while(!stop) {
+        CALL(nested(call_depth));
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+void call_bench(int tasks, int depth) {
+    stop = false;
+    call_depth = depth;
+
+    for(int i = 0; i < tasks; i++) {
+        sched.start(&caller, NULL);
+    }
+
+    uint64_t start = now_ns();
+    for(int i = 0; i < NUM_DISPATCHES; i++) {
+        sched.dispatch();
+    }
+    uint64_t ns = now_ns() - start;
+
+    stop = true;
+    drain();
+
+    result("call_depth", tasks, depth, NUM_DISPATCHES, ns, -1, 0);
+}
+
+int main() {
+    if(!sched.init(&ns_time)) {
+        printf("failed to initialize scheduler\n");
+        return -1;
+    }
+
+    printf("{\n  \"benchmark\": \"sched\",\n  \"results\": [");
+
+    for(int tasks : TASK_COUNTS) {
+        dispatch_bench(tasks);
+        sleep_bench(tasks);
+        block_wake_bench(tasks);
+
+        for(int depth : CALL_DEPTHS) {
+            call_bench(tasks, depth);
+        }
+    }
+
+    printf("\n  ]\n}\n");
+}
@@ -0,0 +1,149 @@
+// tests independent scheduler instances: each has it's own clock, tasks, and
+// TIDs, and the scheduler macros act on whichever one dispatched the task
+//
+// build: g++ -I../.. ../sched.cpp scheduler_test.cpp -o scheduler_test
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+#include "sched/Scheduler.h"
+
+static const tid_t NUM_TASKS = 4;
+
+// one clock per simulated flight computer
+uint32_t ticks[2] = {0, 0};
+uint32_t clock0() {
+    return ticks[0];
+}
+uint32_t clock1() {
+    return ticks[1];
+}
+
+// number of times each scheduler's tasks woke up
+static int wakes[2];
+
+// sleeps for 10 ticks of it's own scheduler's clock, forever
+RetType sleeper(void* arg) {
+    RESUME();
+
+    while(1) {
+        SLEEP(10);
+        wakes[(size_t)arg]++;
+    }
+
+    RESET();
+    return RET_ERROR;
+}
+
+// starts a sleeper on the scheduler that dispatched it, then exits
+RetType starter(void* arg) {
+    sched_start(&sleeper, arg);
+    return RET_ERROR;
+}
+
+void run(Scheduler* sched, int n) {
+    for(int i = 0; i < n; i++) {
+        sched->dispatch();
+    }
+}
+
+bool instance_test() {
+    alloc::Scheduler<NUM_TASKS> scheds[2];
+    scheds[0].init(&clock0);
+    scheds[1].init(&clock1);
+
+    for(size_t i = 0; i < 2; i++) {
+        if(-1 == scheds[i].start(&starter, (void*)i)) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    run(&scheds[0], 2);
+    run(&scheds[1], 2);
+
+    // only advance the first scheduler's clock
+    ticks[0] += 10;
+    run(&scheds[0], 2);
+    run(&scheds[1], 2);
+
+    if(wakes[0] != 1 || wakes[1] != 0) {
+        printf("bad wakes after first clock advanced: %i, %i\n", wakes[0], wakes[1]);
+        return false;
+    }
+
+    ticks[1] += 10;
+    run(&scheds[0], 2);
+    run(&scheds[1], 2);
+
+    if(wakes[0] != 1 || wakes[1] != 1) {
+        printf("bad wakes after second clock advanced: %i, %i\n", wakes[0], wakes[1]);
+        return false;
+    }
+
+    // the starter exited, so only the sleeper is using a TID
+    if(scheds[0].free_tasks() != NUM_TASKS - 1 || scheds[1].free_tasks() != NUM_TASKS - 1) {
+        printf("tasks started on the wrong scheduler\n");
+        return false;
+    }
+
+    // nothing should have touched the default scheduler
+    if(sched_default()->free_tasks() != MAX_NUM_TASKS) {
+        printf("default scheduler has tasks\n");
+        return false;
+    }
+
+    return true;
+}
+
+RetType exiter(void*) {
+    return RET_ERROR;
+}
+
+bool tid_test() {
+    alloc::Scheduler<NUM_TASKS> sched;
+
+    for(tid_t i = 0; i < NUM_TASKS; i++) {
+        if(i != sched.start(&exiter, NULL)) {
+            printf("TIDs not handed out in order\n");
+            return false;
+        }
+    }
+
+    if(-1 != sched.start(&exiter, NULL)) {
+        printf("started more than %i tasks\n", NUM_TASKS);
+        return false;
+    }
+
+    // every task exits and gives it's TID back
+    run(&sched, NUM_TASKS);
+
+    if(NUM_TASKS != sched.free_tasks()) {
+        printf("only %i TIDs freed\n", sched.free_tasks());
+        return false;
+    }
+
+    for(tid_t i = 0; i < NUM_TASKS; i++) {
+        if(-1 == sched.start(&exiter, NULL)) {
+            printf("failed to reuse a TID\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    if(instance_test()) {
+        printf("passed instance test\n");
+    } else {
+        printf("failed instance test\n");
+    }
+
+    if(tid_test()) {
+        printf("passed TID test\n");
+    } else {
+        printf("failed TID test\n");
+    }
+}
@@ -0,0 +1,260 @@
+// replays a 20 minute flight on the virtual clock, a simulated altimeter and
+// accelerometer are sampled at 100Hz by injected events, and the boost,
+// apogee, and landing detectors run on every sample
+//
+// build: g++ -O2 -I../.. -I.. ../sched.cpp sim_test.cpp -o sim_test
+
+#include <stdio.h>
+#include <time.h>
+
+#include "sched/macros.h"
+#include "sched/platforms/sim/SimClock.h"
+#include "event/BoostEvent.h"
+#include "event/ApogeeEvent.h"
+#include "event/LandingEvent.h"
+
+// one tick is one ms
+static const uint32_t FLIGHT_TIME = 20 * 60 * 1000;
+static const uint32_t SAMPLE_PERIOD = 10;
+
+// flight profile, in ms, m, and m/s^2
+static const uint32_t IGNITION = 5000;
+static const uint32_t BURNOUT = 10000;
+static const double BOOST_ACCEL = 100;
+static const double G = 9.81;
+static const double DROGUE_RATE = 30;
+static const double MAIN_RATE = 6;
+static const double MAIN_ALTITUDE = 500;
+
+static double burnout_vel;
+static double burnout_alt;
+static uint32_t apogee_time;
+static double apogee_alt;
+static uint32_t main_time;
+static uint32_t landing_time;
+
+void plan_flight() {
+    double burn = (BURNOUT - IGNITION) / 1000.0;
+    burnout_vel = BOOST_ACCEL * burn;
+    burnout_alt = 0.5 * BOOST_ACCEL * burn * burn;
+
+    double coast = burnout_vel / G;
+    apogee_time = BURNOUT + (uint32_t)(coast * 1000);
+    apogee_alt = burnout_alt + burnout_vel * coast - 0.5 * G * coast * coast;
+
+    main_time = apogee_time + (uint32_t)((apogee_alt - MAIN_ALTITUDE) / DROGUE_RATE * 1000);
+    landing_time = main_time + (uint32_t)(MAIN_ALTITUDE / MAIN_RATE * 1000);
+}
+
+// altitude and acceleration at time 't'
+void profile(uint32_t t, double* alt, double* accel) {
+    if(t < IGNITION) {
+        *alt = 0;
+        *accel = G;
+    } else if(t < BURNOUT) {
+        double s = (t - IGNITION) / 1000.0;
+        *alt = 0.5 * BOOST_ACCEL * s * s;
+        *accel = BOOST_ACCEL + G;
+    } else if(t < apogee_time) {
+        double s = (t - BURNOUT) / 1000.0;
+        *alt = burnout_alt + burnout_vel * s - 0.5 * G * s * s;
+        *accel = 0;
+    } else if(t < main_time) {
+        *alt = apogee_alt - DROGUE_RATE * ((t - apogee_time) / 1000.0);
+        *accel = G;
+    } else if(t < landing_time) {
+        *alt = MAIN_ALTITUDE - MAIN_RATE * ((t - main_time) / 1000.0);
+        *accel = G;
+    } else {
+        *alt = 0;
+        *accel = G;
+    }
+}
+
+// simulated sensor readings
+static int16_t altitude = 0;
+static uint16_t apogee_altitude = 0;
+static int16_t accel = 0;
+static uint32_t samples = 0;
+
+static bool boost_detected = false;
+static bool apogee_detected = false;
+static bool landing_detected = false;
+
+static BoostEvent boost(&boost_detected, &accel, &altitude);
+static ApogeeEvent apogee(&apogee_detected, &apogee_altitude);
+static LandingEvent landing(&landing_detected, &apogee_detected, &accel, &altitude);
+
+static uint32_t boost_at = 0;
+static uint32_t apogee_at = 0;
+static uint32_t landing_at = 0;
+
+static tid_t detect_tid;
+static uint32_t beacons = 0;
+
+// injected every sample period, like a data ready interrupt
+void sensor_ready(void*) {
+    double alt, acc;
+    profile(sim_sched_time(), &alt, &acc);
+
+    altitude = (int16_t)alt;
+    apogee_altitude = (uint16_t)alt;
+    accel = (int16_t)acc;
+
+    sched_wake(detect_tid);
+
+    uint32_t next = sim_sched_time() + SAMPLE_PERIOD;
+    if(next < FLIGHT_TIME) {
+        sim_at(next, &sensor_ready, NULL);
+    }
+}
+
+// runs every detector on each sample
+RetType detect_task(void*) {
+    RESUME();
+
+    while(1) {
+        BLOCK();
+        samples++;
+
+        CALL(boost.calculate_event());
+        CALL(apogee.calculate_event());
+        CALL(landing.calculate_event());
+
+        if(boost_detected && 0 == boost_at) {
+            boost_at = sched_time();
+        }
+
+        if(apogee_detected && 0 == apogee_at) {
+            apogee_at = sched_time();
+        }
+
+        if(landing_detected && 0 == landing_at) {
+            landing_at = sched_time();
+        }
+    }
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+// stands in for a radio beacon, sleeps between transmissions
+RetType beacon_task(void*) {
+    RESUME();
+
+    while(1) {
+        beacons++;
+        SLEEP(1000);
+    }
+
+    RESET();
+    return RET_SUCCESS;
+}
+
+static double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+bool flight_test() {
+    plan_flight();
+
+    if(!sim_sched_init()) {
+        return false;
+    }
+
+    detect_tid = sched_start(&detect_task, NULL);
+    if(-1 == detect_tid || -1 == sched_start(&beacon_task, NULL)) {
+        return false;
+    }
+
+    if(!sim_at(SAMPLE_PERIOD, &sensor_ready, NULL)) {
+        return false;
+    }
+
+    double start = wall_ms();
+    if(!sim_run(FLIGHT_TIME)) {
+        printf("simulation stalled at %u ms\n", sim_sched_time());
+        return false;
+    }
+    double ms = wall_ms() - start;
+
+    printf("replayed %u s in %.1f ms, %u samples, %u beacons\n",
+           FLIGHT_TIME / 1000, ms, samples, beacons);
+    printf("boost at %u ms (ignition %u), apogee at %u ms (actual %u), landing at %u ms (actual %u)\n",
+           boost_at, IGNITION, apogee_at, apogee_time, landing_at, landing_time);
+
+    // first sample is one period in
+    if(samples != FLIGHT_TIME / SAMPLE_PERIOD - 1) {
+        printf("expected %u samples\n", FLIGHT_TIME / SAMPLE_PERIOD - 1);
+        return false;
+    }
+
+    if(beacons != FLIGHT_TIME / 1000) {
+        printf("expected %u beacons\n", FLIGHT_TIME / 1000);
+        return false;
+    }
+
+    if(boost_at < IGNITION || boost_at > BURNOUT) {
+        printf("boost not detected during the burn\n");
+        return false;
+    }
+
+    if(apogee_at < apogee_time || apogee_at > apogee_time + 2000) {
+        printf("apogee not detected within 2 s\n");
+        return false;
+    }
+
+    // the detector's average altitude is only updated once it's in range, so
+    // it stays at the pad altitude and landing is detected when the rocket is
+    // within 50 m of the pad, about 8.3 s before touchdown under the main
+    if(landing_at < landing_time - 10000 || landing_at > landing_time + 2000) {
+        printf("landing not detected within 10 s of touchdown\n");
+        return false;
+    }
+
+    if(ms >= 1000) {
+        printf("replay took longer than 1 s\n");
+        return false;
+    }
+
+    return true;
+}
+
+// blocks forever
+RetType stuck_task(void*) {
+    RESUME();
+
+    BLOCK();
+
+    RESET();
+    return RET_ERROR;
+}
+
+// every task blocked with nothing left to wake them
+bool stall_test() {
+    if(!sim_sched_init(1000)) {
+        return false;
+    }
+
+    if(-1 == sched_start(&stuck_task, NULL)) {
+        return false;
+    }
+
+    return !sim_run(5000) && sim_sched_time() == 1000;
+}
+
+int main() {
+    if(stall_test()) {
+        printf("passed stall test\n");
+    } else {
+        printf("failed stall test\n");
+    }
+
+    if(flight_test()) {
+        printf("passed flight test\n");
+    } else {
+        printf("failed flight test\n");
+    }
+}
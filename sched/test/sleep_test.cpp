@@ -0,0 +1,119 @@
+// tests tasks wake from the sleep queue in order of their wake time,
+// including when the system clock wraps around
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+static const int NUM = 32;
+
+// sleep time of each task, in the order tasks are started
+static uint32_t sleep_time[NUM];
+
+// order tasks woke up in, and how long each slept for
+// TIDs are reused in any order, so don't look up sleep times by TID
+static tid_t woke[NUM];
+static uint32_t woke_sleep[NUM];
+static int num_woke = 0;
+
+RetType sleeper(void* arg) {
+    RESUME();
+
+    SLEEP(*(uint32_t*)arg);
+
+    woke[num_woke] = sched_dispatched;
+    woke_sleep[num_woke] = *(uint32_t*)arg;
+    num_woke++;
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+// runs NUM sleeping tasks starting at time 'start'
+// if 'cancel' is not -1, that task is woken early
+bool run(uint32_t start, tid_t cancel) {
+    tick = start;
+    num_woke = 0;
+
+    tid_t tids[NUM];
+    for(int i = 0; i < NUM; i++) {
+        // spread out the wake times and start them out of order
+        sleep_time[i] = 1 + ((i * 7919) % 97);
+        tids[i] = sched_start(&sleeper, &(sleep_time[i]));
+
+        if(tids[i] < 0) {
+            printf("failed to start task %i\n", i);
+            return false;
+        }
+    }
+
+    // let every task go to sleep
+    for(int i = 0; i < NUM; i++) {
+        sched_dispatch();
+    }
+
+    if(cancel != -1) {
+        WAKE(tids[cancel]);
+        sched_dispatch();
+
+        if(num_woke != 1 || woke[0] != tids[cancel]) {
+            printf("task %i did not wake early\n", cancel);
+            return false;
+        }
+    }
+
+    for(int t = 0; t < 100; t++) {
+        tick++;
+
+        // dispatch until nothing is ready
+        for(int i = 0; i < NUM; i++) {
+            sched_dispatch();
+        }
+    }
+
+    if(num_woke != NUM) {
+        printf("only %i of %i tasks woke up\n", num_woke, NUM);
+        return false;
+    }
+
+    // check the wake order
+    for(int i = 1; i < NUM; i++) {
+        if(woke_sleep[i] < woke_sleep[i - 1] && (cancel == -1 || woke[i - 1] != tids[cancel])) {
+            printf("task %i woke before task %i\n", woke[i - 1], woke[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(run(0, -1)) {
+        printf("passed ordering test\n");
+    } else {
+        printf("failed ordering test\n");
+    }
+
+    if(run(0xFFFFFFF0, -1)) {
+        printf("passed wraparound test\n");
+    } else {
+        printf("failed wraparound test\n");
+    }
+
+    if(run(0xFFFFFFF0, 5)) {
+        printf("passed cancel test\n");
+    } else {
+        printf("failed cancel test\n");
+    }
+}
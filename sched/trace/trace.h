@@ -0,0 +1,91 @@
+/*******************************************************************************
+*
+*  Name: trace.h
+*
+*  Purpose: Streams a binary trace of scheduler dispatches to a file on Linux.
+*           Convert the trace to Chrome/Perfetto JSON with 'trace2json'.
+*           Requires SCHED_PROFILE to be defined.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sched/sched.h"
+
+#ifdef SCHED_PROFILE
+
+/// @brief header at the start of a trace file
+///        followed by 'sched_trace_t' records until the end of the file
+typedef struct {
+    char magic[4];          // "LCST"
+    uint16_t version;       // trace format version
+    uint16_t record_size;   // sizeof(sched_trace_t)
+    uint32_t ticks_per_sec; // profiling clock ticks per second
+} sched_trace_header_t;
+
+static const char SCHED_TRACE_MAGIC[4] = {'L', 'C', 'S', 'T'};
+static const uint16_t SCHED_TRACE_VERSION = 1;
+
+// currently open trace file
+static FILE* _sched_trace_file = NULL;
+
+// trace function passed to the scheduler, appends a record to the file
+static inline void _sched_trace_write(const sched_trace_t* rec) {
+    if(_sched_trace_file) {
+        fwrite(rec, sizeof(sched_trace_t), 1, _sched_trace_file);
+    }
+}
+
+/// @brief open a trace file and start tracing dispatches to it
+/// @param path             the path of the file to write
+/// @param ticks_per_sec    profiling clock ticks per second, used to convert
+///                         the trace to real time
+/// @return 'true' on success, 'false' on failure
+static inline bool sched_trace_open(const char* path, uint32_t ticks_per_sec) {
+    if(_sched_trace_file) {
+        // already tracing
+        return false;
+    }
+
+    _sched_trace_file = fopen(path, "wb");
+    if(!_sched_trace_file) {
+        return false;
+    }
+
+    sched_trace_header_t header;
+    memcpy(header.magic, SCHED_TRACE_MAGIC, sizeof(header.magic));
+    header.version = SCHED_TRACE_VERSION;
+    header.record_size = sizeof(sched_trace_t);
+    header.ticks_per_sec = ticks_per_sec;
+
+    if(1 != fwrite(&header, sizeof(header), 1, _sched_trace_file)) {
+        fclose(_sched_trace_file);
+        _sched_trace_file = NULL;
+        return false;
+    }
+
+    sched_trace(&_sched_trace_write);
+    return true;
+}
+
+/// @brief stop tracing and close the trace file
+static inline void sched_trace_close() {
+    sched_trace(NULL);
+
+    if(_sched_trace_file) {
+        fclose(_sched_trace_file);
+        _sched_trace_file = NULL;
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+// converts a binary scheduler trace written by 'sched_trace_open' to the
+// Chrome trace event JSON format, which can be opened in Perfetto
+// (ui.perfetto.dev) or chrome://tracing
+//
+// build: g++ -DSCHED_PROFILE -I../.. trace2json.cpp -o trace2json
+// usage: ./trace2json trace.bin trace.json
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sched/trace/trace.h"
+
+static const char* ret_name(uint8_t ret) {
+    switch(ret) {
+        case RET_SUCCESS:
+            return "SUCCESS";
+        case RET_ERROR:
+            return "ERROR";
+        case RET_BLOCKED:
+            return "BLOCKED";
+        case RET_SLEEP:
+            return "SLEEP";
+        case RET_YIELD:
+            return "YIELD";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+static const char* state_name(uint8_t state) {
+    switch(state) {
+        case STATE_UNALLOCATED:
+            return "EXITED";
+        case STATE_ACTIVE:
+            return "ACTIVE";
+        case STATE_SLEEPING:
+            return "SLEEPING";
+        case STATE_BLOCKED:
+            return "BLOCKED";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc != 3) {
+        printf("usage: %s <trace.bin> <trace.json>\n", argv[0]);
+        return -1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if(!in) {
+        printf("failed to open %s\n", argv[1]);
+        return -1;
+    }
+
+    sched_trace_header_t header;
+    if(1 != fread(&header, sizeof(header), 1, in) ||
+       0 != memcmp(header.magic, SCHED_TRACE_MAGIC, sizeof(header.magic))) {
+        printf("%s is not a scheduler trace\n", argv[1]);
+        return -1;
+    }
+
+    if(header.version != SCHED_TRACE_VERSION || header.record_size != sizeof(sched_trace_t)) {
+        printf("unsupported trace version %u\n", header.version);
+        return -1;
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if(!out) {
+        printf("failed to open %s\n", argv[2]);
+        return -1;
+    }
+
+    double us_per_tick = 1e6 / header.ticks_per_sec;
+
+    // name each task's track
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for(int tid = 0; tid < MAX_NUM_TASKS; tid++) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,"
+                     "\"args\":{\"name\":\"task %i\"}}", tid ? ",\n" : "", tid, tid);
+    }
+
+    // the profiling clock is 32 bits, keep track of how many times it wrapped
+    uint64_t wraps = 0;
+    uint32_t last = 0;
+    bool first = true;
+    size_t count = 0;
+
+    sched_trace_t rec;
+    while(1 == fread(&rec, sizeof(rec), 1, in)) {
+        if(!first && rec.start < last && (last - rec.start) > 0x80000000UL) {
+            wraps++;
+        }
+        last = rec.start;
+
+        uint64_t start = (wraps << 32) | rec.start;
+
+        fprintf(out, ",\n{\"name\":\"task %i\",\"cat\":\"sched\",\"ph\":\"X\","
+                     "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%i,"
+                     "\"args\":{\"ret\":\"%s\",\"state\":\"%s\"}}",
+                rec.tid, start * us_per_tick, rec.duration * us_per_tick, rec.tid,
+                ret_name(rec.ret), state_name(rec.state));
+
+        first = false;
+        count++;
+    }
+
+    fprintf(out, "\n]}\n");
+
+    fclose(in);
+    fclose(out);
+
+    printf("converted %lu dispatches\n", count);
+    return 0;
+}
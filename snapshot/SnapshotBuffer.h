@@ -0,0 +1,126 @@
+/******************************************************************************
+*  Name: SnapshotBuffer.h
+*
+*  Purpose: Single writer, multiple reader buffer holding the latest value of
+*           an object (e.g. a sensor measurement), implemented as a seqlock.
+*
+*           The writer bumps a sequence number to odd, writes the object, and
+*           bumps it back to even. Readers copy the object out and retry if
+*           the sequence number was odd or changed while they were copying, so
+*           they never see a partial write and never hold up the writer.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+******************************************************************************/
+
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/// @brief single writer, multiple reader latest value buffer
+/// @tparam T   the object type held, copied in and out byte-wise so it must be
+///             trivially copyable (e.g. a measurement struct)
+/// Use 'write' from a single writer (one task, thread, or ISR) to publish a
+/// new value, overwriting the last.
+/// Use 'read' from any number of readers to copy out the latest value.
+/// The writer never waits on readers. A reader retries while a write is in
+/// progress, so a reader that can preempt the writer (e.g. an ISR reading a
+/// value written by a task) should use 'try_read' instead, which never spins.
+template <typename T>
+class SnapshotBuffer {
+public:
+    static_assert(__is_trivially_copyable(T), "SnapshotBuffer type must be trivially copyable");
+
+    /// @brief constructor
+    SnapshotBuffer() : m_seq(0) {
+        memset(m_words, 0, sizeof(m_words));
+    }
+
+    /// @brief publish a new value, only called by the writer
+    /// @param obj  the object to copy in
+    void write(const T& obj) {
+        uint32_t words[WORDS];
+        words[WORDS - 1] = 0;
+        memcpy(words, &obj, sizeof(T));
+
+        uint32_t seq = __atomic_load_n(&m_seq, __ATOMIC_RELAXED);
+
+        // odd while writing, readers won't use anything they copy now
+        __atomic_store_n(&m_seq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        for(size_t i = 0; i < WORDS; i++) {
+            __atomic_store_n(&m_words[i], words[i], __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&m_seq, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    /// @brief try once to copy out the latest value, never spins
+    /// @param obj      filled with the latest value on success
+    /// @param count    set to 'writes()' as of the value copied, if not NULL
+    /// @return 'true' on success, 'false' if a write was in progress, 'obj'
+    ///         may have been changed and should not be used
+    bool try_read(T* obj, uint32_t* count = NULL) {
+        uint32_t words[WORDS];
+
+        uint32_t seq = __atomic_load_n(&m_seq, __ATOMIC_ACQUIRE);
+        if(seq & 1) {
+            // mid write
+            return false;
+        }
+
+        for(size_t i = 0; i < WORDS; i++) {
+            words[i] = __atomic_load_n(&m_words[i], __ATOMIC_RELAXED);
+        }
+
+        // keep the copy before the second check of the sequence number
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(seq != __atomic_load_n(&m_seq, __ATOMIC_RELAXED)) {
+            // written while we were copying, could be torn
+            return false;
+        }
+
+        memcpy((void*)obj, words, sizeof(T));
+
+        if(count) {
+            *count = seq >> 1;
+        }
+
+        return true;
+    }
+
+    /// @brief copy out the latest value, retrying until a write isn't in the way
+    /// @param obj  filled with the latest value
+    /// @return 'writes()' as of the value copied, can be compared against the
+    ///         last read to tell if the value is new, 0 if never written
+    uint32_t read(T* obj) {
+        uint32_t count;
+
+        while(!try_read(obj, &count)) {}
+
+        return count;
+    }
+
+    /// @brief get the number of completed writes
+    /// @return the number of writes
+    uint32_t writes() {
+        return __atomic_load_n(&m_seq, __ATOMIC_ACQUIRE) >> 1;
+    }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // odd while a write is in progress, twice the number of writes otherwise
+    uint32_t m_seq;
+
+    // stored as words so every access to it can be atomic
+    uint32_t m_words[WORDS];
+};
+
+#endif
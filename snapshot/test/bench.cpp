@@ -0,0 +1,132 @@
+// benchmarks the snapshot buffer against a mutex protected copy, with a writer
+// publishing measurements and 0 to 3 reader threads copying them out
+// reports the median and 99th percentile time per write, and the average per
+// read
+//
+// build: g++ -O2 -pthread -I../.. bench.cpp -o bench
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <algorithm>
+
+#include "snapshot/SnapshotBuffer.h"
+#include "common/MeasurementTypes.h"
+
+static const size_t NUM_WRITES = 2000000;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// the same interface with a mutex
+template <typename T>
+class MutexBuffer {
+public:
+    MutexBuffer() : m_count(0) {
+        pthread_mutex_init(&m_lock, NULL);
+        memset(m_obj, 0, sizeof(T));
+    }
+
+    void write(const T& obj) {
+        pthread_mutex_lock(&m_lock);
+        memcpy(m_obj, &obj, sizeof(T));
+        m_count++;
+        pthread_mutex_unlock(&m_lock);
+    }
+
+    uint32_t read(T* obj) {
+        pthread_mutex_lock(&m_lock);
+        memcpy((void*)obj, m_obj, sizeof(T));
+        uint32_t count = m_count;
+        pthread_mutex_unlock(&m_lock);
+
+        return count;
+    }
+
+private:
+    pthread_mutex_t m_lock;
+    uint8_t m_obj[sizeof(T)];
+    uint32_t m_count;
+};
+
+static SnapshotBuffer<AltimeterData> seq_buff;
+static MutexBuffer<AltimeterData> mutex_buff;
+
+static uint32_t write_ns[NUM_WRITES];
+static volatile bool done;
+static size_t reads[3];
+
+template <typename B>
+struct reader_args {
+    B* buff;
+    size_t id;
+};
+
+template <typename B>
+void* reader(void* arg) {
+    reader_args<B>* args = (reader_args<B>*)arg;
+    AltimeterData data = {{1, 0}, 0, 0, 0};
+
+    while(!done) {
+        args->buff->read(&data);
+        reads[args->id]++;
+    }
+
+    return NULL;
+}
+
+template <typename B>
+void run(const char* name, B* buff, size_t num_readers) {
+    pthread_t threads[3];
+    reader_args<B> args[3];
+
+    done = false;
+    for(size_t i = 0; i < num_readers; i++) {
+        reads[i] = 0;
+        args[i].buff = buff;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, &reader<B>, &args[i]);
+    }
+
+    AltimeterData data = {{1, 0}, 20, 101325, 0};
+
+    uint64_t start = now_ns();
+    for(size_t n = 0; n < NUM_WRITES; n++) {
+        data.info.time = n;
+        data.altitude = n;
+
+        uint64_t t = now_ns();
+        buff->write(data);
+        write_ns[n] = now_ns() - t;
+    }
+    uint64_t total = now_ns() - start;
+
+    done = true;
+    size_t total_reads = 0;
+    for(size_t i = 0; i < num_readers; i++) {
+        pthread_join(threads[i], NULL);
+        total_reads += reads[i];
+    }
+
+    // includes the time to read the clock
+    std::sort(write_ns, write_ns + NUM_WRITES);
+
+    // readers may share a core with the writer, so per read is their share of
+    // the total run time
+    printf("%-8s %7lu %14u %14u %10.1f\n", name, num_readers,
+           write_ns[NUM_WRITES / 2], write_ns[NUM_WRITES * 99 / 100],
+           total_reads ? (double)total / total_reads : 0.0);
+}
+
+int main() {
+    printf("buffer   readers  write p50 (ns)  write p99 (ns)  read (ns)\n");
+    for(size_t r = 0; r <= 3; r++) {
+        run("seqlock", &seq_buff, r);
+        run("mutex", &mutex_buff, r);
+    }
+}
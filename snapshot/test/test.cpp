@@ -0,0 +1,145 @@
+// tests the snapshot buffer, including a writer thread and several reader
+// threads checking they never see a partial write
+//
+// build: g++ -O2 -pthread -I../.. test.cpp -o test
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "snapshot/SnapshotBuffer.h"
+#include "common/MeasurementTypes.h"
+
+bool basic() {
+    SnapshotBuffer<AccelerometerData> buff;
+    AccelerometerData data = {{7, 0}, 0, 0, 0};
+
+    if(0 != buff.read(&data) || 0 != buff.writes()) {
+        printf("buffer written before any writes\n");
+        return false;
+    }
+
+    AccelerometerData in = {{7, 100}, 1, -2, 3};
+    buff.write(in);
+
+    AccelerometerData out = {{7, 0}, 0, 0, 0};
+    uint32_t count = 0;
+    if(!buff.try_read(&out, &count) || 1 != count) {
+        printf("try_read failed with no writer\n");
+        return false;
+    }
+
+    if(out.info.id != 7 || out.info.time != 100 || out.x_accel != 1 ||
+       out.y_accel != -2 || out.z_accel != 3) {
+        printf("read wrong value\n");
+        return false;
+    }
+
+    // only the latest value is kept
+    in.x_accel = 10;
+    buff.write(in);
+    in.x_accel = 20;
+    buff.write(in);
+
+    if(3 != buff.read(&out) || 20 != out.x_accel) {
+        printf("didn't read latest value\n");
+        return false;
+    }
+
+    return true;
+}
+
+// every word is the same, any mix of two writes shows up as a mismatch
+typedef struct {
+    uint32_t words[16];
+} wide_t;
+
+static const uint32_t NUM_WRITES = 20000000;
+static const int NUM_READERS = 3;
+
+static SnapshotBuffer<wide_t> wide;
+
+void* writer(void*) {
+    wide_t val;
+
+    for(uint32_t n = 1; n <= NUM_WRITES; n++) {
+        for(size_t i = 0; i < 16; i++) {
+            val.words[i] = n;
+        }
+
+        wide.write(val);
+    }
+
+    return NULL;
+}
+
+static size_t torn[NUM_READERS];
+static size_t backwards[NUM_READERS];
+static size_t reads[NUM_READERS];
+
+void* reader(void* arg) {
+    size_t id = (size_t)arg;
+    wide_t val;
+    uint32_t last = 0;
+
+    while(last != NUM_WRITES) {
+        uint32_t count = wide.read(&val);
+
+        for(size_t i = 0; i < 16; i++) {
+            if(val.words[i] != count) {
+                torn[id]++;
+                break;
+            }
+        }
+
+        if(count < last) {
+            backwards[id]++;
+        }
+
+        last = count;
+        reads[id]++;
+    }
+
+    return NULL;
+}
+
+bool stress() {
+    pthread_t w;
+    pthread_t r[NUM_READERS];
+
+    for(size_t i = 0; i < NUM_READERS; i++) {
+        pthread_create(&r[i], NULL, &reader, (void*)i);
+    }
+    pthread_create(&w, NULL, &writer, NULL);
+
+    pthread_join(w, NULL);
+    for(size_t i = 0; i < NUM_READERS; i++) {
+        pthread_join(r[i], NULL);
+    }
+
+    bool ret = true;
+    for(size_t i = 0; i < NUM_READERS; i++) {
+        if(torn[i] || backwards[i]) {
+            printf("reader %lu saw %lu torn and %lu out of order values\n", i, torn[i], backwards[i]);
+            ret = false;
+        }
+    }
+
+    printf("%u writes, %lu %lu %lu reads\n", NUM_WRITES, reads[0], reads[1], reads[2]);
+    return ret;
+}
+
+int main() {
+    if(basic()) {
+        printf("passed basic test\n");
+    } else {
+        printf("failed basic test\n");
+    }
+
+    if(stress()) {
+        printf("passed stress test\n");
+    } else {
+        printf("failed stress test\n");
+    }
+}
@@ -34,8 +34,10 @@ public:
         tid_t *waiting = m_queue.peek();
         if (waiting) {
             // someone is waiting, let's wake them up
+            // copy the TID first, popping frees it's node back to a pool
+            tid_t tid = *waiting;
             m_queue.pop();
-            WAKE(*waiting);
+            WAKE(tid);
         }
 
         m_lock.release();
@@ -0,0 +1,121 @@
+/*******************************************************************************
+*
+*  Name: WaitQueue.h
+*
+*  Purpose: Provide a queue of tasks blocked waiting for some event, such as
+*           data arriving on a device or socket.
+*
+*  Author: Will Merges
+*
+*  RIT Launch Initiative
+*
+*******************************************************************************/
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include "return.h"
+#include "sched/macros.h"
+#include "sched/Scheduler.h"
+#include "queue/queue_simple.h"
+
+/// @brief queue of blocked tasks
+///        tasks are linked in through their task structure, so no memory is
+///        allocated and any number of tasks can wait on one queue
+///        waiters are woken in the order they started waiting
+///        waiters can belong to different schedulers (e.g. LinuxRuntime
+///        nodes), each is woken through the scheduler running it
+/// NOTE: not safe to use from an ISR, wake from a task (e.g. a device 'poll')
+/// NOTE: the queue isn't locked, tasks on schedulers dispatched by different
+///       threads must not share one
+class WaitQueue {
+public:
+    /// @brief constructor
+    WaitQueue() : m_waiters() {};
+
+    /// @brief block the calling task until it's woken by this queue
+    ///        should be called with CALL, e.g. CALL(queue.wait())
+    ///        the event waited for may have been consumed by another waiter
+    ///        by the time this task runs, so callers should check for it again
+    /// @param timeout  the longest time to wait in ticks, 0 waits forever
+    /// @return RET_SUCCESS if woken, RET_TIMEOUT if 'timeout' passed first
+    RetType wait(uint32_t timeout = 0) {
+        RESUME();
+
+        push(sched_dispatched_task);
+
+        if(0 == timeout) {
+            BLOCK();
+
+            RESET();
+            return RET_SUCCESS;
+        }
+
+        // the scheduler takes us off the queue if we time out
+        RetType ret = BLOCK_TIMEOUT(timeout);
+
+        RESET();
+        return ret;
+    }
+
+    /// @brief wake the task that has been waiting the longest
+    /// @return 'true' if a task was woken, 'false' if none were waiting
+    bool wake_one() {
+        Node<task_t*>* node = m_waiters.peek_node();
+
+        if(NULL == node) {
+            return false;
+        }
+
+        task_t* task = node->data;
+
+        if(task->sched == sched_active()) {
+            // 'wake' takes the task off the queue
+            task->sched->wake(task->tid);
+            return true;
+        }
+
+        // the task runs on another scheduler, take it off the queue here and
+        // queue the wake, it's made ready when that scheduler next dispatches
+        m_waiters.remove_node(node);
+        task->wait_list = NULL;
+        task->sched->wake_isr(task->tid);
+
+        return true;
+    }
+
+    /// @brief wake every waiting task
+    /// @return the number of tasks woken
+    size_t wake_all() {
+        size_t num = 0;
+
+        while(wake_one()) {
+            num++;
+        }
+
+        return num;
+    }
+
+    /// @brief get the number of tasks waiting
+    /// @return the number of waiting tasks
+    size_t size() {
+        return m_waiters.num_nodes();
+    }
+
+private:
+    // helper function to link a task onto the queue
+    void push(task_t* task) {
+        if(NULL != task->wait_list) {
+            // shouldn't happen, a task can only wait on one thing at a time
+            task->wait_list->remove_node(&(task->wait_node));
+        }
+
+        task->wait_node.data = task;
+        task->wait_list = &m_waiters;
+        m_waiters.push_node(&(task->wait_node));
+    }
+
+    // blocked tasks, linked through 'task_t::wait_node'
+    SimpleQueue<task_t*> m_waiters;
+};
+
+#endif
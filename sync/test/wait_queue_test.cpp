@@ -0,0 +1,236 @@
+// tests several tasks can wait on one WaitQueue, are woken in order, are
+// taken off the queue if they time out or are woken some other way, and can
+// be woken from another scheduler
+//
+// build: g++ -I../.. ../../sched/sched.cpp wait_queue_test.cpp -o wait_queue_test
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "sched/macros.h"
+#include "sched/Scheduler.h"
+#include "sync/WaitQueue.h"
+
+uint32_t tick = 0;
+uint32_t systime() {
+    return tick;
+}
+
+static const int NUM_WAITERS = 3;
+
+static WaitQueue queue;
+
+// order tasks were woken in, and what 'wait' returned to them
+static int woken[NUM_WAITERS];
+static RetType results[NUM_WAITERS];
+static int num_woken;
+
+static uint32_t timeout = 0;
+
+RetType waiter(void* arg) {
+    RESUME();
+
+    RetType ret = CALL(queue.wait(timeout));
+
+    int id = (int)(size_t)arg;
+    woken[num_woken] = id;
+    results[num_woken] = ret;
+    num_woken++;
+
+    RESET();
+    return RET_ERROR; // exit the task
+}
+
+// start the waiters and run them until they're all blocked
+bool start(tid_t* tids) {
+    num_woken = 0;
+
+    for(int i = 0; i < NUM_WAITERS; i++) {
+        tids[i] = sched_start(&waiter, (void*)(size_t)i);
+        if(tids[i] < 0) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    for(int i = 0; i < NUM_WAITERS; i++) {
+        sched_dispatch();
+    }
+
+    if(queue.size() != NUM_WAITERS) {
+        printf("expected %i waiters but there are %lu\n", NUM_WAITERS, queue.size());
+        return false;
+    }
+
+    return true;
+}
+
+void run() {
+    for(int i = 0; i < NUM_WAITERS * 2; i++) {
+        sched_dispatch();
+    }
+}
+
+bool wake_one_test() {
+    tid_t tids[NUM_WAITERS];
+    timeout = 0;
+
+    if(!start(tids)) {
+        return false;
+    }
+
+    for(int i = 0; i < NUM_WAITERS; i++) {
+        if(!queue.wake_one()) {
+            printf("wake_one found no waiter\n");
+            return false;
+        }
+
+        run();
+
+        if(num_woken != i + 1 || woken[i] != i || results[i] != RET_SUCCESS) {
+            printf("wake %i woke the wrong task\n", i);
+            return false;
+        }
+    }
+
+    if(queue.wake_one()) {
+        printf("wake_one woke a task on an empty queue\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool wake_all_test() {
+    tid_t tids[NUM_WAITERS];
+    timeout = 0;
+
+    if(!start(tids)) {
+        return false;
+    }
+
+    if(queue.wake_all() != NUM_WAITERS || queue.size() != 0) {
+        printf("wake_all didn't wake every task\n");
+        return false;
+    }
+
+    run();
+
+    if(num_woken != NUM_WAITERS) {
+        printf("only %i tasks ran after wake_all\n", num_woken);
+        return false;
+    }
+
+    return true;
+}
+
+bool timeout_test() {
+    tid_t tids[NUM_WAITERS];
+    timeout = 5;
+    tick = 0;
+
+    if(!start(tids)) {
+        return false;
+    }
+
+    // wake the middle task directly, it should come off the queue
+    WAKE(tids[1]);
+    if(queue.size() != NUM_WAITERS - 1) {
+        printf("woken task is still on the queue\n");
+        return false;
+    }
+
+    run();
+
+    // the rest time out and come off the queue
+    tick = 5;
+    run();
+
+    if(queue.size() != 0) {
+        printf("timed out tasks are still on the queue\n");
+        return false;
+    }
+
+    if(num_woken != NUM_WAITERS || woken[0] != 1 || results[0] != RET_SUCCESS ||
+       results[1] != RET_TIMEOUT || results[2] != RET_TIMEOUT) {
+        printf("bad wake results\n");
+        return false;
+    }
+
+    return true;
+}
+
+// waiters started on another scheduler, woken from the default one
+bool other_sched_test() {
+    static alloc::Scheduler<NUM_WAITERS> other;
+    timeout = 0;
+    num_woken = 0;
+
+    if(!other.init(&systime)) {
+        printf("failed to init second scheduler\n");
+        return false;
+    }
+
+    for(int i = 0; i < NUM_WAITERS; i++) {
+        if(other.start(&waiter, (void*)(size_t)i) < 0) {
+            printf("failed to start task\n");
+            return false;
+        }
+    }
+
+    for(int i = 0; i < NUM_WAITERS; i++) {
+        other.dispatch();
+    }
+
+    if(queue.size() != NUM_WAITERS) {
+        printf("expected %i waiters but there are %lu\n", NUM_WAITERS, queue.size());
+        return false;
+    }
+
+    if(queue.wake_all() != NUM_WAITERS || queue.size() != 0) {
+        printf("wake_all didn't wake every task\n");
+        return false;
+    }
+
+    for(int i = 0; i < NUM_WAITERS * 2; i++) {
+        other.dispatch();
+    }
+
+    if(num_woken != NUM_WAITERS || woken[0] != 0 || woken[2] != 2) {
+        printf("only %i tasks ran on the second scheduler\n", num_woken);
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    if(!sched_init(&systime)) {
+        printf("failed to init scheduler\n");
+        return -1;
+    }
+
+    if(wake_one_test()) {
+        printf("passed wake one test\n");
+    } else {
+        printf("failed wake one test\n");
+    }
+
+    if(wake_all_test()) {
+        printf("passed wake all test\n");
+    } else {
+        printf("failed wake all test\n");
+    }
+
+    if(timeout_test()) {
+        printf("passed timeout test\n");
+    } else {
+        printf("failed timeout test\n");
+    }
+
+    if(other_sched_test()) {
+        printf("passed other scheduler test\n");
+    } else {
+        printf("failed other scheduler test\n");
+    }
+}